@@ -13,6 +13,48 @@
  */
 
 #include <BK108X.h>
+#include <BK108XIO.h>
+
+#if !defined(PROGMEM)
+#define PROGMEM
+#endif
+#if !defined(pgm_read_word)
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#endif
+#if !defined(pgm_read_ptr)
+#define pgm_read_ptr(addr) (*(void *const *)(addr))
+#endif
+
+// Band limits and channel spaces (see setBand and setSpace). They are stored in flash and
+// the values of the current band are cached in the object by updateBandCache.
+static const uint16_t fmStartBand[4] PROGMEM = {6400, 7400, 7600, 8700};  // Start FM band limit
+static const uint16_t fmEndBand[4] PROGMEM = {10800, 7600, 9100, 10800};  // End FM band limit
+static const uint16_t fmSpace[4] PROGMEM = {1, 5, 10, 20};                // FM channel space
+
+static const uint16_t amStartBand[4] PROGMEM = {153, 520, 2300, 522};     // Start AM band limit
+static const uint16_t amEndBand[4] PROGMEM = {279, 1710, 21850, 1710};    // End AM band limit
+static const uint16_t amSpace[4] PROGMEM = {1, 5, 9, 10};                 // AM channel space
+
+#if defined(IRAM_ATTR)
+#define BK_ISR_ATTR IRAM_ATTR // ESP32/ESP8266 ISRs must run from IRAM
+#else
+#define BK_ISR_ATTR
+#endif
+
+#if defined(BK108X_STATS)
+#define BK_STATS(statement) statement // Instrumentation (see getStats)
+#else
+#define BK_STATS(statement)
+#endif
+
+// AF following states (see pollAf). The receiver is out of the program channel from AF_PROBE on.
+#define AF_MONITOR 0 // Watching the status snapshot
+#define AF_GAP 1     // Round in progress, audio on the program channel between two probes
+#define AF_PROBE 2   // Tuned to the AF being measured (muted)
+#define AF_RETURN 3  // Tuning back to the program channel (muted)
+#define AF_SWITCH 4  // Tuning to the best AF (muted)
+#define AF_VERIFY 5  // Tuned to the best AF, waiting for a group with the PI (audio on)
+
 
 /** 
  * @defgroup GA02 BEKEN I2C BUS 
@@ -26,7 +68,7 @@
  * After a few unsuccessful attempts at using the Arduino I2C library, I decided to write the necessary I2C routines to deal 
  * with BK1086/88 device. 
  * 
- * @see setI2C, i2cInit, i2cStart, i2cEndTransaction(), i2cAck, i2cNack, i2cReceiveAck, i2cWriteByte, i2cReadByte, writeRegister, readRegister
+ * @see setI2C, setI2CSpeed, setI2CFastIO, i2cInit, i2cStart, i2cEndTransaction(), i2cAck, i2cNack, i2cReceiveAck, i2cWriteByte, i2cReadByte, writeRegister, readRegister
  * 
  * IMPORTANT: 
  * For stable communication, the rising edge time of SCLK should be less than 200ns.
@@ -43,10 +85,46 @@ void BK108X::setI2C(uint8_t i2c_addr) {
     this->deviceAddress = i2c_addr;
 }
 
+/**
+ * @ingroup GA02
+ * @brief Sets the I2C bus speed
+ * @details The bus is bit-banged, so the speed is set by the delay used in each half clock period.
+ * @details Above 500kHz the delay is removed (the bus runs as fast as the MCU can toggle the pins).
+ * @details The default value is 500kHz (1us half period). The slowest bus is about 2kHz (255us half period).
+ * 
+ * @param khz bus clock in kHz (approximated)
+ */
+void BK108X::setI2CSpeed(uint16_t khz)
+{
+    uint16_t halfPeriod = (khz > 500 || khz == 0) ? 0 : 500 / khz;
+    this->i2cHalfPeriod = (halfPeriod > 255) ? 255 : halfPeriod; // i2cHalfPeriod is 8 bits: 2kHz is the slowest bus
+}
+
+/**
+ * @ingroup GA02
+ * @brief Enables or disables the direct port I/O for the I2C bus
+ * @details When enabled (default), the SDIO and SCLK pins resolved by i2cInit are toggled via port registers.
+ * @details When disabled or not supported by the platform, the library uses digitalWrite/digitalRead.
+ * @details It can be called before setup (the preference is applied by i2cInit) or after it.
+ * 
+ * @param value true = direct port I/O; false = portable implementation
+ */
+void BK108X::setI2CFastIO(bool value)
+{
+#if defined(BK108X_FAST_IO)
+    this->fastIOAllowed = value;
+    if (this->pin_sdio >= 0 && this->pin_sclk >= 0)
+        this->i2cInit(this->pin_sdio, this->pin_sclk);
+#else
+    (void)value;
+#endif
+}
+
 /**
  * @ingroup GA02
  * @brief Sets the MCU pins connected to the I2C bus 
  * @details Configures the I2C bus for BK108X
+ * @details If the platform supports direct port I/O, the pins are also resolved to port/mask pairs here.
  * 
  * @param pin_sdio SDA/SDIO MCU/Arduino pin
  * @param pin_sclk CLK/SCLK MCU/Arduino pin 
@@ -54,6 +132,137 @@ void BK108X::setI2C(uint8_t i2c_addr) {
 void BK108X::i2cInit(int pin_sdio, int pin_sclk){
     this->pin_sdio = pin_sdio;
     this->pin_sclk = pin_sclk;  
+
+#if defined(BK108X_FAST_IO)
+    this->fastIO = this->fastIOAllowed && bkResolvePin(pin_sdio, ioSdio, true) && bkResolvePin(pin_sclk, ioSclk, false);
+#endif
+}
+
+#if defined(BK108X_FAST_IO)
+/**
+ * @ingroup GA02
+ * @brief Resolves an MCU pin to its port registers and bit mask
+ * @details Used by i2cInit and BK108XPinBus. It also sets the pin up for direct port I/O.
+ * @param pin   MCU/Arduino pin
+ * @param io    returns the port/mask pair
+ * @param sdio  true for the bidirectional SDIO pin
+ * @return false if the pin cannot be toggled through the port registers
+ */
+bool bkResolvePin(int pin, bk_io_pin &io, bool sdio)
+{
+    if (pin < 0)
+        return false;
+#if defined(__AVR__)
+    (void)sdio; // DDR and PORT/PIN registers cover both directions
+    uint8_t port = digitalPinToPort(pin);
+    if (port == NOT_A_PIN)
+        return false;
+    io.out = portOutputRegister(port);
+    io.in = portInputRegister(port);
+    io.dir = portModeRegister(port);
+    io.mask = digitalPinToBitMask(pin);
+#elif defined(ARDUINO_ARCH_STM32)
+    io.port = digitalPinToPort(pin);
+    io.mask = digitalPinToBitMask(pin);
+    io.shift = 2 * __builtin_ctz(io.mask);
+    pinMode(pin, OUTPUT); // Enables the port clock and configures speed/type
+#else
+    if (pin > 31)
+        return false;
+    io.mask = 1UL << pin;
+    pinMode(pin, (sdio) ? INPUT : OUTPUT);
+#if defined(ARDUINO_ARCH_ESP32)
+    if (sdio)
+        gpio_set_direction((gpio_num_t)pin, GPIO_MODE_INPUT_OUTPUT); // keeps the input path while SDIO drives the bus
+#endif
+#endif
+    return true;
+}
+#endif
+
+/**
+ * @ingroup GA02
+ * @brief Drives the SDIO pin
+ * @param value HIGH or LOW
+ */
+inline void BK108X::sdioWrite(uint8_t value)
+{
+#if defined(BK108X_FAST_IO)
+    if (this->fastIO)
+    {
+        if (value)
+            BK_IO_HIGH(ioSdio);
+        else
+            BK_IO_LOW(ioSdio);
+        return;
+    }
+#endif
+    digitalWrite(this->pin_sdio, value);
+}
+
+/**
+ * @ingroup GA02
+ * @brief Drives the SCLK pin
+ * @param value HIGH or LOW
+ */
+inline void BK108X::sclkWrite(uint8_t value)
+{
+#if defined(BK108X_FAST_IO)
+    if (this->fastIO)
+    {
+        if (value)
+            BK_IO_HIGH(ioSclk);
+        else
+            BK_IO_LOW(ioSclk);
+        return;
+    }
+#endif
+    digitalWrite(this->pin_sclk, value);
+}
+
+/**
+ * @ingroup GA02
+ * @brief Sets the SDIO pin direction
+ * @param mode INPUT or OUTPUT
+ */
+inline void BK108X::sdioMode(uint8_t mode)
+{
+#if defined(BK108X_FAST_IO)
+    if (this->fastIO)
+    {
+        if (mode == OUTPUT)
+            BK_IO_OUTPUT(ioSdio);
+        else
+            BK_IO_INPUT(ioSdio);
+        return;
+    }
+#endif
+    pinMode(this->pin_sdio, mode);
+}
+
+/**
+ * @ingroup GA02
+ * @brief Reads the SDIO pin
+ * @return HIGH or LOW
+ */
+inline uint8_t BK108X::sdioRead()
+{
+#if defined(BK108X_FAST_IO)
+    if (this->fastIO)
+        return BK_IO_READ(ioSdio);
+#endif
+    return digitalRead(this->pin_sdio);
+}
+
+/**
+ * @ingroup GA02
+ * @brief Waits for half I2C clock period
+ * @see setI2CSpeed
+ */
+inline void BK108X::i2cDelay()
+{
+    if (this->i2cHalfPeriod)
+        delayMicroseconds(this->i2cHalfPeriod);
 }
 
 /**
@@ -62,17 +271,22 @@ void BK108X::i2cInit(int pin_sdio, int pin_sclk){
  */
 void BK108X::i2cBeginTransaction()
 {
-    pinMode(this->pin_sdio, OUTPUT);
-    pinMode(this->pin_sclk, OUTPUT);
-    digitalWrite(this->pin_sdio, HIGH);
-    digitalWrite(this->pin_sclk, HIGH);
-    delayMicroseconds(1);
+    sdioMode(OUTPUT);
+#if defined(BK108X_FAST_IO)
+    if (this->fastIO)
+        BK_IO_OUTPUT(ioSclk);
+    else
+#endif
+        pinMode(this->pin_sclk, OUTPUT);
+    sdioWrite(HIGH);
+    sclkWrite(HIGH);
+    i2cDelay();
 
-    digitalWrite(this->pin_sdio, LOW);
-    delayMicroseconds(1);
-    digitalWrite(this->pin_sclk, LOW);
-    delayMicroseconds(1);
-    digitalWrite(this->pin_sdio, HIGH);
+    sdioWrite(LOW);
+    i2cDelay();
+    sclkWrite(LOW);
+    i2cDelay();
+    sdioWrite(HIGH);
 }
 
 /**
@@ -81,15 +295,15 @@ void BK108X::i2cBeginTransaction()
  */
 void BK108X::i2cEndTransaction()
 {
-    pinMode(pin_sdio, OUTPUT);
-    digitalWrite(this->pin_sdio, LOW);
-    delayMicroseconds(1);
+    sdioMode(OUTPUT);
+    sdioWrite(LOW);
+    i2cDelay();
 
-    digitalWrite(this->pin_sclk, HIGH);
-    delayMicroseconds(1);
+    sclkWrite(HIGH);
+    i2cDelay();
 
-    digitalWrite(this->pin_sdio, HIGH);
-    delayMicroseconds(1);
+    sdioWrite(HIGH);
+    i2cDelay();
 }
 
 /**
@@ -101,13 +315,13 @@ void BK108X::i2cEndTransaction()
  */
 void BK108X::i2cAck()
 {
-    pinMode(pin_sdio, OUTPUT);
-    digitalWrite(this->pin_sclk, LOW);
-    digitalWrite(this->pin_sdio, LOW);
-    delayMicroseconds(1);
-    digitalWrite(this->pin_sclk, HIGH);
-    delayMicroseconds(1);
-    digitalWrite(this->pin_sclk, LOW);
+    sdioMode(OUTPUT);
+    sclkWrite(LOW);
+    sdioWrite(LOW);
+    i2cDelay();
+    sclkWrite(HIGH);
+    i2cDelay();
+    sclkWrite(LOW);
 }
 
 /**
@@ -117,14 +331,14 @@ void BK108X::i2cAck()
  */
 void BK108X::i2cNack()
 {
-    pinMode(pin_sdio, OUTPUT);
+    sdioMode(OUTPUT);
 
-    digitalWrite(this->pin_sclk, LOW);
-    digitalWrite(this->pin_sdio, HIGH);
-    delayMicroseconds(1);
-    digitalWrite(this->pin_sclk, HIGH);
-    delayMicroseconds(1);
-    digitalWrite(this->pin_sclk, LOW);
+    sclkWrite(LOW);
+    sdioWrite(HIGH);
+    i2cDelay();
+    sclkWrite(HIGH);
+    i2cDelay();
+    sclkWrite(LOW);
 }
 
 /**
@@ -136,16 +350,16 @@ void BK108X::i2cNack()
 uint8_t BK108X::i2cReceiveAck()
 {
     uint8_t ack;
-    pinMode(pin_sdio, INPUT);
-    delayMicroseconds(1);
+    sdioMode(INPUT);
+    i2cDelay();
 
-    digitalWrite(this->pin_sclk, HIGH);
-    delayMicroseconds(1);
+    sclkWrite(HIGH);
+    i2cDelay();
 
-    ack = digitalRead(this->pin_sdio);
+    ack = sdioRead();
 
-    digitalWrite(this->pin_sclk, LOW);
-    delayMicroseconds(1);
+    sclkWrite(LOW);
+    i2cDelay();
 
     return ack;
 }
@@ -157,17 +371,17 @@ uint8_t BK108X::i2cReceiveAck()
  */
 void BK108X::i2cWriteByte( uint8_t data)
 {
-    pinMode(pin_sdio, OUTPUT);
-    delayMicroseconds(1);
+    sdioMode(OUTPUT);
+    i2cDelay();
 
     for (int i = 0; i < 8; i++) {
 
-        digitalWrite(this->pin_sdio, (bool)(data & this->deviceAddress) );
+        sdioWrite((bool)(data & 0x80));
 
-        delayMicroseconds(1);
-        digitalWrite(this->pin_sclk, HIGH);
-        delayMicroseconds(1);
-        digitalWrite(this->pin_sclk, LOW);
+        i2cDelay();
+        sclkWrite(HIGH);
+        i2cDelay();
+        sclkWrite(LOW);
         data = data << 1;
     }
 }
@@ -181,23 +395,199 @@ uint8_t BK108X::i2cReadByte()
 {
     uint8_t value = 0;
 
-    pinMode(pin_sdio, INPUT);
-    delayMicroseconds(1);
+    sdioMode(INPUT);
+    i2cDelay();
 
     for (int i = 0; i < 8; i++)
     {
-        digitalWrite(this->pin_sclk, HIGH);
+        sclkWrite(HIGH);
         value = value << 1;
-        delayMicroseconds(1);
-        if ( digitalRead(this->pin_sdio) ) 
+        i2cDelay();
+        if ( sdioRead() ) 
             value = value | 1;
-        digitalWrite(this->pin_sclk, LOW);
-        delayMicroseconds(1);
+        sclkWrite(LOW);
+        i2cDelay();
     }
 
     return value;
 }
 
+/**
+ * @ingroup GA02
+ * @brief Writes bytes to the device starting at a given register (built-in bit-banged bus)
+ * @details A single I2C transaction: device address, register address (reg << 1, write operation) and the data.
+ * @details The BK108X internal address counter increments after each 16 bits word.
+ * @details The transaction stops at the first byte not acknowledged.
+ * @param reg     first register
+ * @param data    bytes to be written (high byte first)
+ * @param length  number of bytes
+ * @return false if the device did not acknowledge
+ */
+bool BK108X::i2cWrite(uint8_t reg, const uint8_t *data, uint8_t length)
+{
+    bool ack;
+
+    this->i2cBeginTransaction();
+    this->i2cWriteByte(this->deviceAddress);
+    ack = this->i2cReceiveAck() == 0;
+    if (ack)
+    {
+        this->i2cWriteByte(reg << 1); // Converts address and sets to write operation
+        ack = this->i2cReceiveAck() == 0;
+    }
+    for (uint8_t i = 0; ack && i < length; i++)
+    {
+        this->i2cWriteByte(data[i]);
+        ack = this->i2cReceiveAck() == 0;
+    }
+    this->i2cEndTransaction();
+    return ack;
+}
+
+/**
+ * @ingroup GA02
+ * @brief Reads bytes from the device starting at a given register (built-in bit-banged bus)
+ * @details A single I2C transaction: device address, register address ((reg << 1) | 1, read operation) and the data.
+ * @param reg     first register
+ * @param data    buffer that receives the bytes (high byte first)
+ * @param length  number of bytes
+ * @return false if the device did not acknowledge the address bytes
+ */
+bool BK108X::i2cRead(uint8_t reg, uint8_t *data, uint8_t length)
+{
+    bool ack;
+
+    this->i2cBeginTransaction();
+    this->i2cWriteByte(this->deviceAddress);
+    ack = this->i2cReceiveAck() == 0;
+    if (ack)
+    {
+        this->i2cWriteByte((reg << 1) | 1); // Converts address and sets to read operation
+        ack = this->i2cReceiveAck() == 0;
+    }
+    for (uint8_t i = 0; ack && i < length; i++)
+    {
+        data[i] = this->i2cReadByte();
+        if (i < length - 1)
+            this->i2cAck();
+        else
+            this->i2cNack();
+    }
+    this->i2cEndTransaction();
+    return ack;
+}
+
+/**
+ * @ingroup GA02
+ * @brief Counts a transaction not acknowledged and waits before the next attempt
+ * @param attempt  attempts already done minus one
+ * @return true if the transaction has to be repeated; false if all retries were used
+ */
+bool BK108X::busRetry(uint8_t attempt)
+{
+    this->busErrors.nacks++;
+    if (attempt >= this->busRetries)
+    {
+        this->busErrors.failures++;
+        return false;
+    }
+    this->busErrors.retries++;
+    if (this->busBackoff)
+        delayMicroseconds(this->busBackoff << attempt);
+    return true;
+}
+
+/**
+ * @ingroup GA02
+ * @brief Writes bytes to the device starting at a given register
+ * @details Uses the transport set by setTransport or the built-in bit-banged bus. A transaction not acknowledged
+ * @details is repeated according to the retry policy (see setBusRetry) and counted (see getBusErrors).
+ * @param reg     first register
+ * @param data    bytes to be written (high byte first)
+ * @param length  number of bytes
+ * @return false if the transaction failed after all retries
+ */
+bool BK108X::busWrite(uint8_t reg, const uint8_t *data, uint8_t length)
+{
+    bool ack;
+    BK_STATS(uint32_t start = micros());
+    for (uint8_t attempt = 0;; attempt++)
+    {
+        BK_STATS(this->stats.transactions++);
+        ack = (this->transport != NULL) ? this->transport->write(reg, data, length) : i2cWrite(reg, data, length);
+        if (ack || !busRetry(attempt))
+            break;
+    }
+#if defined(BK108X_STATS)
+    this->stats.busTime += micros() - start;
+    for (uint8_t i = 0; i < length / 2; i++)
+        this->stats.writes[(reg + i) & 0x1F]++;
+#endif
+    return ack;
+}
+
+/**
+ * @ingroup GA02
+ * @brief Reads bytes from the device starting at a given register
+ * @details Same retry policy of busWrite.
+ * @param reg     first register
+ * @param data    buffer that receives the bytes (high byte first)
+ * @param length  number of bytes
+ * @return false if the transaction failed after all retries (data is not valid)
+ */
+bool BK108X::busRead(uint8_t reg, uint8_t *data, uint8_t length)
+{
+    bool ack;
+    BK_STATS(uint32_t start = micros());
+    for (uint8_t attempt = 0;; attempt++)
+    {
+        BK_STATS(this->stats.transactions++);
+        ack = (this->transport != NULL) ? this->transport->read(reg, data, length) : i2cRead(reg, data, length);
+        if (ack || !busRetry(attempt))
+            break;
+    }
+#if defined(BK108X_STATS)
+    this->stats.busTime += micros() - start;
+    for (uint8_t i = 0; i < length / 2; i++)
+        this->stats.reads[(reg + i) & 0x1F]++;
+#endif
+    return ack;
+}
+
+/**
+ * @ingroup GA02
+ * @brief Waits a given time in ms
+ * @details Used for the fixed delays (power up, band change) and by the blocking functions while they poll the 
+ * @details device. The time is counted in the instrumentation (see getStats).
+ * @param ms_value  time in ms
+ */
+void BK108X::waitMs(uint16_t ms_value)
+{
+    delay(ms_value);
+    BK_STATS(this->stats.delayTime += ms_value);
+}
+
+#if defined(BK108X_STATS)
+/**
+ * @ingroup GA02
+ * @brief Adds a latency to a histogram of the instrumentation
+ * @param histogram  tuneLatency or seekLatency (BK_STATS_BUCKETS buckets)
+ * @param maximum    longest latency of the histogram (ms)
+ * @param start      millis() when the operation started
+ */
+void BK108X::statsLatency(uint16_t *histogram, uint16_t &maximum, uint32_t start)
+{
+    uint32_t elapsed = millis() - start;
+    uint8_t bucket = 0;
+
+    while (elapsed >> bucket && bucket < BK_STATS_BUCKETS - 1)
+        bucket++;
+    histogram[bucket]++;
+    if (elapsed > maximum)
+        maximum = (elapsed > 0xFFFF) ? 0xFFFF : elapsed;
+}
+#endif
+
 /**
  * @ingroup GA02
  * @brief Sends an array of values to a BK108X given register
@@ -207,23 +597,12 @@ uint8_t BK108X::i2cReadByte()
 void BK108X::writeRegister(uint8_t reg, uint16_t value) {
 
     word16_to_bytes data;
-    data.raw = value;
-    
-    this->i2cBeginTransaction();
-    this->i2cWriteByte(this->deviceAddress);
-    this->i2cReceiveAck();
-
-    reg = reg << 1; // Converts address and sets to write operation
-
-    this->i2cWriteByte(reg);
-    this->i2cReceiveAck();
-
-    this->i2cWriteByte(data.refined.highByte);
-    this->i2cReceiveAck();
-    this->i2cWriteByte(data.refined.lowByte);
-    this->i2cReceiveAck();
+    uint8_t bytes[2];
 
-    this->i2cEndTransaction();
+    data.raw = value;
+    bytes[0] = data.refined.highByte;
+    bytes[1] = data.refined.lowByte;
+    busWrite(reg, bytes, 2);
 }
 
 /**
@@ -235,26 +614,104 @@ void BK108X::writeRegister(uint8_t reg, uint16_t value) {
 uint16_t BK108X::readRegister(uint8_t reg) {
 
     word16_to_bytes data;
+    uint8_t bytes[2] = {0xFF, 0xFF};
 
-    this->i2cBeginTransaction();
-    this->i2cWriteByte(this->deviceAddress);
-    this->i2cReceiveAck();
+    busRead(reg, bytes, 2);
+    data.refined.highByte = bytes[0];
+    data.refined.lowByte = bytes[1];
 
-    reg = (reg << 1) | 1;  // Converts address and sets to read operation
+    return data.raw;
+}
 
-    this->i2cWriteByte(reg);
-    this->i2cReceiveAck();
 
-    data.refined.highByte = this->i2cReadByte();
-    this->i2cAck();
-    data.refined.lowByte = this->i2cReadByte();
-    this->i2cNack();
+/**
+ * @ingroup GA02
+ * @brief Writes a sequence of registers in a single I2C transaction
+ * @details The device register address is sent once and the internal address counter of the BK108X 
+ * @details increments after each 16 bits word. The data is packed into a stack buffer, so each transaction 
+ * @details carries up to BK_BURST_REGISTERS registers. Longer sequences are split into more transactions. 
+ * @details The shadowRegisters array is updated with the values written.
+ * @details After each transaction, it waits the longest settle time of the registers written (see setRegisterSettleTime).
+ * 
+ * @param first  first register to be written
+ * @param count  number of registers
+ * @param in     values (in can point to shadowRegisters)
+ * @return false if a transaction failed (see getBusErrors). The shadowRegisters already have the new values.
+ */
+bool BK108X::writeRegisters(uint8_t first, uint8_t count, const uint16_t *in)
+{
+    while (count > 0)
+    {
+        uint8_t buffer[BK_BURST_REGISTERS * 2];
+        uint8_t n = (count > BK_BURST_REGISTERS) ? BK_BURST_REGISTERS : count;
+        word16_to_bytes data;
 
-    this->i2cEndTransaction();
+        for (uint8_t i = 0; i < n; i++)
+        {
+            data.raw = in[i];
+            buffer[i * 2] = data.refined.highByte;
+            buffer[i * 2 + 1] = data.refined.lowByte;
+            shadowRegisters[(first + i) & 0x1F] = in[i]; // Syncs with the shadowRegisters
+        }
 
-    return data.raw;
+        if (!busWrite(first, buffer, n * 2))
+            return false;
+
+        uint8_t settle = 0;
+        for (uint8_t i = 0; i < n; i++)
+            if (registerSettle[(first + i) & 0x1F] > settle)
+                settle = registerSettle[(first + i) & 0x1F];
+        if (settle)
+        {
+            delayMicroseconds(settle);
+            BK_STATS(this->stats.settleTime += settle);
+        }
+
+        first += n;
+        in += n;
+        count -= n;
+    }
+    return true;
 }
 
+/**
+ * @ingroup GA02
+ * @brief Reads a sequence of registers in a single I2C transaction
+ * @details The device register address is sent once and the registers are read in sequence into a stack buffer
+ * @details (up to BK_BURST_REGISTERS registers per transaction). The shadowRegisters array is updated with the values read.
+ * 
+ * @param first  first register to be read
+ * @param count  number of registers
+ * @param out    array that will receive the values. Can be NULL if only shadowRegisters has to be updated. 
+ * @return false if a transaction failed (see getBusErrors). In this case, shadowRegisters and out are not changed.
+ */
+bool BK108X::readRegisters(uint8_t first, uint8_t count, uint16_t *out)
+{
+    while (count > 0)
+    {
+        uint8_t buffer[BK_BURST_REGISTERS * 2];
+        uint8_t n = (count > BK_BURST_REGISTERS) ? BK_BURST_REGISTERS : count;
+        word16_to_bytes data;
+
+        if (!busRead(first, buffer, n * 2))
+            return false;
+
+        for (uint8_t i = 0; i < n; i++)
+        {
+            data.refined.highByte = buffer[i * 2];
+            data.refined.lowByte = buffer[i * 2 + 1];
+            shadowRegisters[(first + i) & 0x1F] = data.raw; // Syncs with the shadowRegisters
+            if (out != NULL)
+                out[i] = data.raw;
+        }
+
+        first += n;
+        if (out != NULL)
+            out += n;
+        count -= n;
+    }
+    return true;
+}
 
 /** 
  * @defgroup GA03 Basic Functions
@@ -267,13 +724,12 @@ uint16_t BK108X::readRegister(uint8_t reg) {
  * @see shadowRegisters;  
  * @param device register address
  * @return the register content (the shadowRegisters array has this content. So, you do not need to use it most of the cases)
+ * @return If the transaction fails, the shadowRegisters content is not changed and returned.
  */
 uint16_t BK108X::getRegister(uint8_t reg)
 {
-    uint16_t reg_content;
-    reg_content = this->readRegister(reg);
-    shadowRegisters[reg] = reg_content; // Syncs with the shadowRegisters
-    return reg_content;                 // Optional
+    readRegisters(reg, 1, NULL);        // Syncs with the shadowRegisters
+    return shadowRegisters[reg & 0x1F]; // Optional
 }
 
 /**
@@ -284,15 +740,125 @@ uint16_t BK108X::getRegister(uint8_t reg)
  * @details The registers from 0x2 to 0x07 are used to setup the device. This method writes the array  shadowRegisters, elements 8 to 14 (corresponding the registers 0x2 to 0x7 respectively)  into the device. See Device registers map  in BK108X.h file.
  * @details To implement this, a register maping was created to deal with each register structure. For each type of register, there is a reference to the array element. 
  *  
- * @see shadowRegisters; 
+ * @details After writing, it waits the settle time configured for the register (see setRegisterSettleTime).
+ * @details Between beginUpdate and commit, only shadowRegisters is changed and the register is marked as dirty.
+ *  
+ * @see shadowRegisters, setRegisterSettleTime, beginUpdate, commit
  * 
  * @param device register address
  */
 void BK108X::setRegister(uint8_t reg, uint16_t value)
 {
+    if (this->updateLevel)
+    {
+        shadowRegisters[reg] = value;
+        dirtyRegisters |= 1UL << reg;
+        // Power and Channel registers start actions on the device. So, they can not wait for commit.
+        if (reg != REG02 && reg != REG03)
+            return;
+        flushUpdate();
+        return;
+    }
     this->writeRegister(reg, value);
     shadowRegisters[reg] = value;  // Syncs with the shadowRegisters
-    delayMicroseconds(250);
+    if (registerSettle[reg])
+    {
+        delayMicroseconds(registerSettle[reg]);
+        BK_STATS(this->stats.settleTime += registerSettle[reg]);
+    }
+}
+
+/**
+ * @ingroup GA03
+ * @brief Starts a batch of register changes
+ * @details Until commit is called, the setters (setVolume, setSoftMuteAttack, setMuteThreshold, setBand etc) only 
+ * @details change shadowRegisters and mark the registers as dirty. commit writes each changed register once.
+ * @details Changes on Power (0x02) and Channel (0x03) registers start device actions (tune, seek, power), 
+ * @details so they flush the pending changes and are written immediately.
+ * @details Calls can be nested. Only the outermost commit writes to the device.
+ * @details Do not call getRegister for a dirty register before commit. It overwrites the pending value.
+ * @code
+ * rx.beginUpdate();
+ * rx.setVolume(20);
+ * rx.setSoftMuteAttack(1);
+ * rx.setSoftMuteAttenuation(2);
+ * rx.setMuteThreshold(26, 5);
+ * rx.commit(); // REG05, REG06 and REG14 are written once
+ * @endcode
+ * @see commit
+ */
+void BK108X::beginUpdate()
+{
+    if (this->updateLevel++ == 0)
+    {
+#if !defined(BK108X_SLIM)
+        memcpy(updateSnapshot, shadowRegisters, sizeof(shadowRegisters));
+#endif
+        dirtyRegisters = 0;
+    }
+}
+
+/**
+ * @ingroup GA03
+ * @brief Writes the registers changed since beginUpdate
+ * @details Registers whose value is identical to the value they had on beginUpdate are skipped. In the BK108X_SLIM
+ * @details profile, there is no snapshot of the registers: every register changed by a setter is written.
+ * @details The changed registers are written in ascending order using burst transactions. A single unchanged
+ * @details configuration register between two changed registers is written too, so both fit one transaction.
+ * @see beginUpdate
+ */
+void BK108X::commit()
+{
+    if (this->updateLevel == 0)
+        return;
+    if (--this->updateLevel == 0)
+        flushUpdate();
+}
+
+/**
+ * @ingroup GA03
+ * @brief Writes the pending changes of the current batch
+ * @see beginUpdate, commit
+ */
+void BK108X::flushUpdate()
+{
+#if defined(BK108X_SLIM)
+    uint32_t changed = dirtyRegisters;
+#else
+    uint32_t changed = 0;
+
+    for (uint8_t reg = 0; reg < 32; reg++)
+        if ((dirtyRegisters & (1UL << reg)) && shadowRegisters[reg] != updateSnapshot[reg])
+            changed |= 1UL << reg;
+#endif
+
+    uint8_t reg = 0;
+    while (reg < 32)
+    {
+        if (!(changed & (1UL << reg)))
+        {
+            reg++;
+            continue;
+        }
+        uint8_t last = reg;
+        // Extends the run while the next register is changed or it is a single configuration register gap
+        while (last < 31)
+        {
+            if (changed & (1UL << (last + 1)))
+                last++;
+            else if (last < 30 && (changed & (1UL << (last + 2))) && ((last + 1 >= REG04 && last + 1 <= REG08) || (last + 1 >= REG10 && last + 1 <= REG1D)))
+                last += 2;
+            else
+                break;
+        }
+        writeRegisters(reg, last - reg + 1, &shadowRegisters[reg]);
+        reg = last + 1;
+    }
+
+#if !defined(BK108X_SLIM)
+    memcpy(updateSnapshot, shadowRegisters, sizeof(shadowRegisters));
+#endif
+    dirtyRegisters = 0;
 }
 
 /**
@@ -343,132 +909,680 @@ bk_reg0a BK108X::getStatus()
 
 /**
  * @ingroup GA03
- * @brief   Wait STC (Seek/Tune Complete) status becomes 0
- * @details Should be used before processing Tune or Seek.
- * @details The STC bit being cleared indicates that the TUNE or SEEK bits may be set again to start another tune or seek operation. Do not set the TUNE or SEEK bits until the BK108X clears the STC bit. 
+ * @brief Reads all device registers (0x00 to 0x1F) into shadowRegisters
+ * @details Uses two burst transactions instead of 32 register reads.
+ * @see getShadownRegister, setAllRegisters, readRegisters
  */
-void BK108X::waitAndFinishTune()
+void BK108X::getAllRegisters()
 {
-    while ( reg0a->refined.STC == 0) {
-        delay(10);
-        getRegister(REG0A);
-    }
-
-    reg03->refined.TUNE = 0;
-    setRegister(REG03, reg03->raw);
-    // delay(40);
+    readRegisters(REG00, 32, NULL);
 }
 
 /**
  * @ingroup GA03
- * @brief Resets the device
+ * @brief Writes the shadowRegisters content into the device
+ * @details Writes the configuration registers 0x02 to 0x08 and 0x10 to 0x1D (the status and RDS registers are read only).
+ * @see setShadownRegister, getAllRegisters, writeRegisters
  */
-void BK108X::reset()
+void BK108X::setAllRegisters()
 {
-    reg02->refined.DISABLE = 1;
-    reg02->refined.ENABLE = 0;
-    setRegister(REG02, reg02->raw);
-    reg02->refined.DISABLE = 0;
-    reg02->refined.ENABLE = 1;
-    setRegister(REG02, reg02->raw);
+    writeRegisters(REG02, REG08 - REG02 + 1, &shadowRegisters[REG02]);
+    writeRegisters(REG10, REG1D - REG10 + 1, &shadowRegisters[REG10]);
 }
 
 /**
  * @ingroup GA03
- * @brief Powers the receiver on 
- * @details Starts the receiver and set default configurations suggested by the BELEN
- * @see BEKEN - BK1086/88 - BROADCAST AM/FM/SW/LW RADIO RECEIVER Rev 1.3; pages 12-21
- * @see setup
+ * @brief Starts the adaptive STC polling of a tune, scan step or seek
+ * @param maxInterval  maximum interval between two status reads (ms)
+ * @param firstPoll    time (ms) from now to the first status read
  */
-void BK108X::powerUp()
+void BK108X::startStcPolling(uint8_t maxInterval, uint16_t firstPoll)
 {
-    // Starts the mains register with default values suggested by BEKEN.
-
-    reg02->raw = 0x0280;            // Sets to 0 all attributes of the register 0x02 (Power Configuration)
-    reg02->refined.DISABLE = 0;     // Force stereo
-    reg02->refined.ENABLE = 1;      // Power the receiver UP (DISABLE has to be 0)
-    setRegister(REG02,reg02->raw);  // Stores the register 0x02
-
-    setRegister(REG03, 0x0000);     // Sets to 0 all attributes of the register 0x03 (Channel)
-
-    setRegister(REG04, 0x60D4);     // 0b0110000011010100
-    setRegister(REG05, 0x37CF);     // 0b0011011111001111
-
-    
-    reg06->raw = 0x086F;            // Sets to the default value - 0b0000100001101111 -> CLKSEL = 1
-    reg06->refined.CLKSEL = this->oscillatorType;  // Sets to the clock type selected by the user
-    setRegister(REG06, reg06->raw);
-
-    setRegister(REG07, 0x0101); // 0b0000000100000001
-    setRegister(REG08, 0xAC90); // 0b1010110010010000
-
-    setRegister(REG10, 0x7B11); // 0b0111101100010001
-    setRegister(REG11, 0x004A); // 0b0000000001001010
-    setRegister(REG12, 0x4000); // 0b0100000000000000
-    setRegister(REG13, 0x3E00); // 0b0011111000000000
-    setRegister(REG14, 0xC29A); // 0b1100001010011010
-    setRegister(REG15, 0x79F8); // 0b0111100111111000
-    setRegister(REG16, 0x4012); // 0b0100000000010010
-
-    // setRegister(REG17, 0x0040); // 0b0000000001000000
-    setRegister(REG17, 0x0800); // 0b0000100000000000
-    setRegister(REG18, 0x341C); // 0b0011010000011100
-    setRegister(REG19, 0x0080); // 0b0000000010000000
-    setRegister(REG1A, 0x0000); // 0
-    setRegister(REG1B, 0x4CA2); // 0b0100110010100010
+    this->stcInterval = BK_STC_POLL_MIN;
+    this->stcMaxInterval = maxInterval;
+    this->stcReads = 0;
+    this->stcNextPoll = millis() + firstPoll;
+}
 
-    // setRegister(REG1C, 0x8820); // 0b1000100000100000
-    setRegister(REG1C, 0); // 0b1000100000100000
-    setRegister(REG1D, 0x0200); // 0b0000001000000000  ->  512
+/**
+ * @ingroup GA03
+ * @brief Checks if the status register has to be read to check STC
+ * @details With seekInterruptPin, the status is read when the device signals (see hasInterrupt). Otherwise, the 
+ * @details reads are paced: the first one a little before the latency learned for the band (see getTuneLatency), 
+ * @details then after BK_STC_POLL_MIN ms, doubling up to the maximum interval of the operation. A fast tune is 
+ * @details seen about 1 to 2ms after STC, and a slow one does not flood the bus with status reads.
+ * @return true if the status has to be read now
+ */
+bool BK108X::isStcPollDue()
+{
+    if (this->seekInterruptPin >= 0)
+        return hasInterrupt(BK_IRQ_STC, this->seekInterruptPin);
 
-    delay(250);
+    uint32_t now = millis();
+    if ((int32_t)(now - this->stcNextPoll) < 0)
+        return false;
+    this->stcNextPoll = now + this->stcInterval;
+    if (this->stcReads < 0xFF)
+        this->stcReads++;
+    if (this->stcInterval < this->stcMaxInterval)
+        this->stcInterval <<= 1;
+    return true;
 }
 
 /**
  * @ingroup GA03
- * @brief Powers the receiver off
+ * @brief Updates the tune latency learned for the current band with the tune just completed
+ * @details Moving average (1/4 of the new value). The latency seen includes the polling delay, so it converges 
+ * @details slightly above the device latency. When polling, if STC was already set at the first read, the device may 
+ * @details be faster than learned: half of the time seen is used, so the first read moves earlier until it sees 
+ * @details STC == 0. With seekInterruptPin, the time seen is the device latency and is used as it is.
  */
-void BK108X::powerDown()
+void BK108X::learnStcLatency()
 {
-    reg02->refined.DISABLE = 1;
-    reg02->refined.ENABLE = 0;
-    setRegister(REG02, reg02->raw);
-    delay(100);
+    uint8_t &latency = this->stcLatency[(this->currentMode << 2) | (reg05()->refined.BAND & 3)];
+    uint32_t elapsed = millis() - this->tuneStartTime;
+
+    if (this->seekInterruptPin < 0 && this->stcReads == 1)
+        elapsed /= 2; // Polled and STC already set at the first read
+    if (elapsed > 255)
+        elapsed = 255;
+    latency = (latency == 0) ? elapsed : (3 * latency + elapsed + 2) / 4;
 }
 
 /**
  * @ingroup GA03
- * @brief Starts the device 
- * @details sets the reset pin, interrupt pins and oscillator type you are using in your project.
- * @details You have to inform at least two parameters: RESET pin and I2C SDA pin of your MCU
- * @param rdsInterruptPin  // optional. Sets the Interrupt Arduino pin used to RDS function control.
- * @param seekInterruptPin // optional. Sets the Arduino pin used to Seek function control. 
- * @param oscillator_type  // optional. Sets the Oscillator type used Crystal (default) or Ref. Clock. 
+ * @brief   Wait STC (Seek/Tune Complete) status becomes 0
+ * @details Should be used before processing Tune or Seek.
+ * @details The STC bit being cleared indicates that the TUNE or SEEK bits may be set again to start another tune or seek operation. Do not set the TUNE or SEEK bits until the BK108X clears the STC bit. 
+ * @details This is the blocking version of pollTune. 
+ * @see startTune, pollTune
  */
-void BK108X::setup(int sda_pin, int sclk_pin, int rdsInterruptPin, int seekInterruptPin, uint8_t oscillator_type)
+void BK108X::waitAndFinishTune()
 {
-    // Configures BEKEN I2C bus 
-    this->i2cInit(sda_pin, sclk_pin);
+    if (this->tuneState != BK_TUNE_IN_PROGRESS)
+    {
+        this->tuneChannel = reg03()->refined.CHAN;
+        this->tuneStartTime = millis();
+        uint8_t latency = getTuneLatency();
+        startStcPolling(BK_STC_POLL_MAX, latency - latency / 8); // Same pacing as startTuneChannel
+        this->tuneState = BK_TUNE_IN_PROGRESS;
+    }
 
-    if (rdsInterruptPin >= 0)
-        this->rdsInterruptPin = rdsInterruptPin;
-    if (seekInterruptPin >= 0)
-        this->seekInterruptPin = seekInterruptPin;
+    while (pollTune() == BK_TUNE_IN_PROGRESS)
+        waitMs(1); // pollTune reads the status only when it is due (see isStcPollDue)
+}
 
-    this->oscillatorType = oscillator_type;
+/**
+ * @ingroup GA03
+ * @brief Starts tuning a given channel and returns immediately
+ * @details Call pollTune in your loop to complete the tune.
+ * @see pollTune, startTune
+ * @param channel 
+ */
+void BK108X::startTuneChannel(uint16_t channel)
+{
+    if (reg03()->refined.TUNE && !reg02()->refined.SEEK)
+    {
+        // The previous tune was not completed by pollTune. TUNE has to go from 0 to 1 to start a new one.
+        reg03()->refined.TUNE = 0;
+        setRegister(REG03, reg03()->raw);
+    }
+    reg03()->refined.TUNE = 1;
+    reg03()->refined.CHAN = channel;
 
-    powerUp();
+    if (reg02()->refined.SEEK)
+    {
+        reg02()->refined.SEEK = 0;
+        writeRegisters(REG02, 2, &shadowRegisters[REG02]); // Stops seeking and tunes in a single transaction
+    }
+    else
+        setRegister(REG03, reg03()->raw);
 
+    reg0a()->refined.STC = 0; // The shadow of the status register can hold the STC of the previous tune
+    this->lastStatusPoll = millis();
+    abortAf();
+    this->tuneChannel = channel;
+    this->tuneStartTime = this->lastStatusPoll;
+    uint8_t latency = getTuneLatency();
+    startStcPolling(BK_STC_POLL_MAX, latency - latency / 8);
+    this->signalQualityValid = false;
+    clearRdsBuffer();
+    this->tuneState = BK_TUNE_IN_PROGRESS;
 }
 
 /**
  * @ingroup GA03
- * @brief Sets the receiver to FM mode
- * @details Configures the receiver on FM mode; Also sets the band limits, defaul frequency and step.
- * 
- * @param minimum_frequency  minimum frequency for the band
- * @param maximum_frequency  maximum frequency for the band
- * @param default_frequency  default freuency
+ * @brief Starts tuning a given frequency and returns immediately
+ * @details Unlike setFrequency, this function does not wait for the device to complete the tune.
+ * @details This way, the main loop can keep servicing the display and encoder while the device settles.
+ * @code
+ * void loop() {
+ *   if (encoderCount != 0) {
+ *      rx.startTune(rx.getFrequency() + 10);
+ *      encoderCount = 0;
+ *   }
+ *   if (rx.pollTune() == BK_TUNE_DONE)
+ *      showFrequency();
+ *   // Other tasks 
+ * }
+ * @endcode
+ * @see pollTune, setTuneCallback, setFrequency
+ * @param frequency 
+ */
+void BK108X::startTune(uint16_t frequency)
+{
+    this->currentFrequency = frequency;
+    this->startTuneChannel(frequencyToChannel(frequency));
+}
+
+/**
+ * @ingroup GA03
+ * @brief Checks and completes the tune started by startTune
+ * @details Reads the status register (0x0A). When STC is 1, it clears the TUNE bit and calls the tune callback.
+ * @details If seekInterruptPin is set, the status register is read only after the device signals the tune completion.
+ * @details Otherwise, the status reads are paced by the adaptive STC polling (see isStcPollDue).
+ * @details The tune is dropped if the status cannot be read (bus error) or if STC does not come within the tune
+ * @details timeout (see setTuneTimeout). So, a missing or unpowered device does not hang the callers.
+ * @see startTune, setTuneCallback
+ * @details In tune target mode, a completed tune that is not on the latest target starts the tune of the target.
+ * @return BK_TUNE_IN_PROGRESS while the device is tuning; BK_TUNE_DONE once, when the tune completes; 
+ * @return BK_TUNE_TIMEOUT or BK_TUNE_ERROR once, when the tune is dropped; BK_TUNE_IDLE otherwise.
+ */
+uint8_t BK108X::pollTune()
+{
+    if (this->tuneState != BK_TUNE_IN_PROGRESS)
+        return BK_TUNE_IDLE;
+    BK_STATS(this->stats.tunePolls++);
+
+    bool timeout = (millis() - this->tuneStartTime) > this->tuneTimeout;
+    if (!timeout && !isStcPollDue())
+        return BK_TUNE_IN_PROGRESS;
+
+    if (!readRegisters(REG0A, 1, NULL))
+    {
+        this->tuneState = BK_TUNE_IDLE;
+        return BK_TUNE_ERROR;
+    }
+    if (reg0a()->refined.STC == 0)
+    {
+        if (!timeout)
+            return BK_TUNE_IN_PROGRESS;
+        this->busErrors.timeouts++;
+        this->tuneState = BK_TUNE_IDLE;
+        reg03()->refined.TUNE = 0;
+        setRegister(REG03, reg03()->raw);
+        return BK_TUNE_TIMEOUT;
+    }
+
+    reg03()->refined.TUNE = 0;
+    setRegister(REG03, reg03()->raw);
+
+    BK_STATS(statsLatency(this->stats.tuneLatency, this->stats.tuneMax, this->tuneStartTime));
+    learnStcLatency();
+    if (this->tuneTargetMode && frequencyToChannel(this->currentFrequency) != this->tuneChannel)
+    {
+        // The target moved during the tune (see setTuneTargetMode): the intermediate channel is dropped
+        startTuneChannel(frequencyToChannel(this->currentFrequency));
+        return BK_TUNE_IN_PROGRESS;
+    }
+    this->currentChannel = this->tuneChannel;
+    this->tuneState = BK_TUNE_IDLE;
+    this->signalQualityValid = false;
+    if (this->tuneCallback != NULL)
+        this->tuneCallback();
+
+    return BK_TUNE_DONE;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Resets the device
+ */
+void BK108X::reset()
+{
+    reg02()->refined.DISABLE = 1;
+    reg02()->refined.ENABLE = 0;
+    setRegister(REG02, reg02()->raw);
+    reg02()->refined.DISABLE = 0;
+    reg02()->refined.ENABLE = 1;
+    setRegister(REG02, reg02()->raw);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Powers the receiver on 
+ * @details Starts the receiver and set default configurations suggested by the BELEN
+ * @see BEKEN - BK1086/88 - BROADCAST AM/FM/SW/LW RADIO RECEIVER Rev 1.3; pages 12-21
+ * @see setup
+ */
+void BK108X::powerUp()
+{
+    // Starts the mains register with default values suggested by BEKEN.
+
+    reg02()->raw = 0x0280;            // Sets to 0 all attributes of the register 0x02 (Power Configuration)
+    reg02()->refined.DISABLE = 0;     // Force stereo
+    reg02()->refined.ENABLE = 1;      // Power the receiver UP (DISABLE has to be 0)
+
+    reg03()->raw = 0x0000;            // Sets to 0 all attributes of the register 0x03 (Channel)
+
+    reg04()->raw = 0x60D4;            // 0b0110000011010100
+    reg05()->raw = 0x37CF;            // 0b0011011111001111
+
+    reg06()->raw = 0x086F;            // Sets to the default value - 0b0000100001101111 -> CLKSEL = 1
+    reg06()->refined.CLKSEL = this->oscillatorType;  // Sets to the clock type selected by the user
+
+    reg07()->raw = 0x0101; // 0b0000000100000001
+    reg08()->raw = 0xAC90; // 0b1010110010010000
+
+    // Registers 0x02 to 0x08 in a single transaction
+    writeRegisters(REG02, REG08 - REG02 + 1, &shadowRegisters[REG02]);
+
+    reg10()->raw = 0x7B11; // 0b0111101100010001
+    reg11()->raw = 0x004A; // 0b0000000001001010
+    reg12()->raw = 0x4000; // 0b0100000000000000
+    reg13()->raw = 0x3E00; // 0b0011111000000000
+    reg14()->raw = 0xC29A; // 0b1100001010011010
+    reg15()->raw = 0x79F8; // 0b0111100111111000
+    reg16()->raw = 0x4012; // 0b0100000000010010
+
+    // reg17()->raw = 0x0040; // 0b0000000001000000
+    reg17()->raw = 0x0800; // 0b0000100000000000
+    reg18()->raw = 0x341C; // 0b0011010000011100
+    reg19()->raw = 0x0080; // 0b0000000010000000
+    reg1A()->raw = 0x0000; // 0
+    reg1b()->raw = 0x4CA2; // 0b0100110010100010
+
+    // reg1c()->raw = 0x8820; // 0b1000100000100000
+    reg1c()->raw = 0; // 0b1000100000100000
+    reg1d()->raw = 0x0200; // 0b0000001000000000  ->  512
+
+    // Registers 0x10 to 0x1D in a single transaction
+    writeRegisters(REG10, REG1D - REG10 + 1, &shadowRegisters[REG10]);
+
+    waitMs(250);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Saves the receiver state 
+ * @details Copies the writable registers (shadow of 0x02 to 0x08 and 0x10 to 0x1D) and the band, space, frequency 
+ * @details and volume fields to a bk_state image. Store it (RAM, EEPROM, flash) and use restoreState to resume.
+ * @details No I2C transaction is used.
+ * @see restoreState
+ * @param state image to be filled
+ */
+void BK108X::saveState(bk_state &state)
+{
+    state.magic = BK_STATE_MAGIC;
+    memcpy(state.reg02_08, &shadowRegisters[REG02], sizeof(state.reg02_08));
+    memcpy(state.reg10_1D, &shadowRegisters[REG10], sizeof(state.reg10_1D));
+    state.frequency = this->currentFrequency;
+    state.minimumFrequency = this->minimumFrequency;
+    state.maximumFrequency = this->maximumFrequency;
+    state.step = this->currentStep;
+    state.mode = this->currentMode;
+    state.fmBand = this->currentFMBand;
+    state.amBand = this->currentAMBand;
+    state.fmSpace = this->currentFMSpace;
+    state.amSpace = this->currentAMSpace;
+    state.volume = this->currentVolume;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Powers the receiver up from a saved state (warm resume)
+ * @details Unlike powerUp followed by setFM/setAM, setVolume etc, the saved register image is written in two 
+ * @details transactions (0x02 to 0x08 with the receiver enabled, and 0x10 to 0x1D) and the saved channel is tuned 
+ * @details right away. Instead of a fixed delay, it waits for the first tune to complete (STC), which only happens 
+ * @details after the oscillator has settled. This wait is limited to maxDelayAftarCrystalOn (see setDelayAfterCrystalOn).
+ * @code
+ * bk_state state;
+ * 
+ * rx.saveState(state);
+ * rx.powerDown();
+ * .
+ * .
+ * rx.restoreState(state); // Back to the same band, frequency and volume
+ * @endcode
+ * @see saveState, setDelayAfterCrystalOn
+ * @param state image saved by saveState
+ * @return false if the image is not valid (nothing was done) or the tune did not complete in maxDelayAftarCrystalOn
+ *         ms (in this case, pollTune completes it). 
+ */
+bool BK108X::restoreState(const bk_state &state)
+{
+    if (state.magic != BK_STATE_MAGIC)
+        return false;
+
+    memcpy(&shadowRegisters[REG02], state.reg02_08, sizeof(state.reg02_08));
+    memcpy(&shadowRegisters[REG10], state.reg10_1D, sizeof(state.reg10_1D));
+    this->currentFrequency = state.frequency;
+    this->minimumFrequency = state.minimumFrequency;
+    this->maximumFrequency = state.maximumFrequency;
+    this->currentStep = state.step;
+    this->currentMode = state.mode;
+    this->currentFMBand = state.fmBand;
+    this->currentAMBand = state.amBand;
+    this->currentFMSpace = state.fmSpace;
+    this->currentAMSpace = state.amSpace;
+    this->currentVolume = state.volume;
+    updateBandCache();
+    this->oscillatorType = reg06()->refined.CLKSEL;
+
+    reg02()->refined.DISABLE = 0;
+    reg02()->refined.ENABLE = 1;
+    reg02()->refined.SEEK = 0;
+    reg03()->refined.TUNE = 0;
+    this->seekState = BK_SEEK_IDLE;
+    this->scanState = BK_SCAN_IDLE;
+
+    if (!writeRegisters(REG02, REG08 - REG02 + 1, &shadowRegisters[REG02]) || 
+        !writeRegisters(REG10, REG1D - REG10 + 1, &shadowRegisters[REG10]))
+        return false;
+
+    uint8_t status;
+    uint32_t start = millis();
+    startTune(this->currentFrequency);
+    while ((status = pollTune()) == BK_TUNE_IN_PROGRESS)
+    {
+        if ((millis() - start) > this->maxDelayAftarCrystalOn)
+            return false;
+        waitMs(1);
+    }
+    return status == BK_TUNE_DONE;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Powers the receiver off
+ */
+void BK108X::powerDown()
+{
+    reg02()->refined.DISABLE = 1;
+    reg02()->refined.ENABLE = 0;
+    setRegister(REG02, reg02()->raw);
+    waitMs(100);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Puts the receiver in standby
+ * @details Powers the receiver off via REG02 (DISABLE = 1, ENABLE = 0) without waiting and keeps the shadow 
+ * @details registers and the current channel. A seek, scan or AF check in progress is stopped and tick does not use 
+ * @details the bus until resume is called.
+ * @code
+ * rx.standby();      // Display off
+ * .
+ * rx.resume();       // Display on: the station is back in a tune time
+ * @endcode
+ * @see resume, powerDown
+ */
+void BK108X::standby()
+{
+    if (this->standbyMode)
+        return;
+    if (isSeeking())
+        cancelSeek();
+    abortAf();
+    this->scanState = BK_SCAN_IDLE;
+    this->tuneState = BK_TUNE_IDLE;
+
+    reg02()->refined.DISABLE = 1;
+    reg02()->refined.ENABLE = 0;
+    setRegister(REG02, reg02()->raw);
+    this->signalQualityValid = false;
+    this->standbyMode = true;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Resumes the receiver put in standby
+ * @details Powers the receiver on (DISABLE = 0, ENABLE = 1) and restores the registers 0x02 to 0x08 from the shadow 
+ * @details registers in a single transaction. Then, the current channel is tuned again without blocking (see 
+ * @details startTune and pollTune; tick completes it). Unlike setup, powerUp is not run: no register defaults and 
+ * @details no 250ms wait.
+ * @see standby
+ */
+void BK108X::resume()
+{
+    if (!this->standbyMode)
+        return;
+    this->standbyMode = false;
+
+    reg02()->refined.DISABLE = 0;
+    reg02()->refined.ENABLE = 1;
+    reg03()->refined.TUNE = 0;
+    writeRegisters(REG02, REG08 - REG02 + 1, &shadowRegisters[REG02]);
+    startTuneChannel(this->currentChannel);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Starts the device 
+ * @details sets the reset pin, interrupt pins and oscillator type you are using in your project.
+ * @details You have to inform at least two parameters: RESET pin and I2C SDA pin of your MCU
+ * @details If interrupt pins are given, the BK108X GPIO2 is configured as STC/RDS interrupt output and the library reads
+ * @details the status register only when the device signals (see setupInterrupts). 
+ * @param rdsInterruptPin  // optional. Sets the Interrupt Arduino pin used to RDS function control (connected to GPIO2).
+ * @param seekInterruptPin // optional. Sets the Arduino pin used to Seek function control (connected to GPIO2). It can be the same rdsInterruptPin.
+ * @param oscillator_type  // optional. Sets the Oscillator type used Crystal (default) or Ref. Clock. 
+ * @return false if the transport set by setTransport could not be set up (see BK108XTransport::begin). In this 
+ *         case the device is not powered up.
+ */
+bool BK108X::setup(int sda_pin, int sclk_pin, int rdsInterruptPin, int seekInterruptPin, uint8_t oscillator_type)
+{
+    // Configures BEKEN I2C bus (or the transport set by setTransport)
+    if (this->transport != NULL)
+    {
+        if (!this->transport->begin())
+            return false;
+    }
+    else
+        this->i2cInit(sda_pin, sclk_pin);
+
+    releaseInterrupts(); // A second setup: the ISRs of the previous pins are detached before the new pins are set
+    if (rdsInterruptPin >= 0)
+        this->rdsInterruptPin = rdsInterruptPin;
+    if (seekInterruptPin >= 0)
+        this->seekInterruptPin = seekInterruptPin;
+
+    this->oscillatorType = oscillator_type;
+
+    clearRdsBuffer();
+    powerUp();
+    setupInterrupts();
+    return true;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Starts the device from a saved state (warm resume)
+ * @details Same as setup, but the receiver is powered up with the image saved by saveState (see restoreState). 
+ * @details The oscillator type is taken from the image. If the image is not valid, the receiver is powered up 
+ * @details with the default configuration (see powerUp) and false is returned.
+ * @param sda_pin  MCU pin connected to SDIO
+ * @param sclk_pin MCU pin connected to SCLK
+ * @param state image saved by saveState
+ * @param rdsInterruptPin  optional. See setup.
+ * @param seekInterruptPin optional. See setup.
+ * @return the restoreState result (false also if the transport could not be set up: the device is not powered up)
+ */
+bool BK108X::setup(int sda_pin, int sclk_pin, const bk_state &state, int rdsInterruptPin, int seekInterruptPin)
+{
+    if (this->transport != NULL)
+    {
+        if (!this->transport->begin())
+            return false;
+    }
+    else
+        this->i2cInit(sda_pin, sclk_pin);
+
+    clearRdsBuffer();
+    if (state.magic != BK_STATE_MAGIC)
+        powerUp();
+    bool result = restoreState(state); // The interrupts are not attached yet. So, it polls STC. 
+
+    releaseInterrupts(); // See setup
+    if (rdsInterruptPin >= 0)
+        this->rdsInterruptPin = rdsInterruptPin;
+    if (seekInterruptPin >= 0)
+        this->seekInterruptPin = seekInterruptPin;
+    setupInterrupts();
+    return result;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Receivers served by the interrupt service routines
+ * @details The BK108X GPIO2 pin sends a 5ms low pulse when a seek/tune completes (STCIEN) and when a new RDS group 
+ * @details is received (RDSIEN). The ISRs below only set the interrupt flags of their receiver. The I2C bus is used 
+ * @details later, by pollTune and getRdsReady.  
+ * @details attachInterrupt takes a function without arguments. So, each slot has its own ISRs and up to 
+ * @details BK_IRQ_SLOTS receivers can use interrupt pins at the same time.
+ */
+BK108X *volatile BK108X::interruptOwners[BK_IRQ_SLOTS] = {NULL, NULL};
+
+/**
+ * @ingroup GA03
+ * @brief ISR of a slot: sets the flags of the receiver of the slot
+ * @details BK_IRQ_STC for the seekInterruptPin, BK_IRQ_RDS for the rdsInterruptPin or both when they are the same
+ * @details pin (the GPIO2 pulse does not tell the reason).
+ */
+template <uint8_t SLOT, uint8_t FLAGS>
+BK_ISR_ATTR void BK108X::interruptHandler()
+{
+    BK108X *rx = interruptOwners[SLOT];
+    if (rx != NULL)
+        rx->interruptFlags |= FLAGS;
+}
+
+void (*const BK108X::interruptHandlers[BK_IRQ_SLOTS][3])() PROGMEM = {
+    {interruptHandler<0, BK_IRQ_STC>, interruptHandler<0, BK_IRQ_RDS>, interruptHandler<0, BK_IRQ_STC | BK_IRQ_RDS>},
+    {interruptHandler<1, BK_IRQ_STC>, interruptHandler<1, BK_IRQ_RDS>, interruptHandler<1, BK_IRQ_STC | BK_IRQ_RDS>}};
+
+/**
+ * @ingroup GA03
+ * @brief Configures GPIO2 as STC/RDS interrupt output and attaches the ISRs
+ * @details GPIO2 is the only interrupt output of the BK108X (GPIO3 is the Mono/Stereo indicator). 
+ * @details Both MCU pins must be connected to GPIO2. You can use the same pin for both parameters of setup.
+ * @details The receiver takes a free slot of interruptOwners. If BK_IRQ_SLOTS receivers already use interrupt pins, 
+ * @details the pins are ignored and this receiver polls the status register.
+ * @see setup, pollTune, getRdsReady
+ */
+void BK108X::setupInterrupts()
+{
+    if (this->seekInterruptPin < 0 && this->rdsInterruptPin < 0)
+        return;
+
+    if (this->interruptSlot < 0)
+    {
+        noInterrupts();
+        for (uint8_t i = 0; i < BK_IRQ_SLOTS && this->interruptSlot < 0; i++)
+            if (interruptOwners[i] == NULL)
+            {
+                interruptOwners[i] = this;
+                this->interruptSlot = i;
+            }
+        interrupts();
+        if (this->interruptSlot < 0)
+        {
+            this->seekInterruptPin = this->rdsInterruptPin = -1; // No slot left: polling
+            return;
+        }
+    }
+    void (*const *handlers)() = interruptHandlers[this->interruptSlot]; // In flash: read with pgm_read_ptr
+
+    this->interruptFlags = 0;
+    reg04()->refined.GPIO2 = 1; // STC/RDS interrupt
+    reg04()->refined.STCIEN = (this->seekInterruptPin >= 0);
+    reg04()->refined.RDSIEN = (this->rdsInterruptPin >= 0);
+    setRegister(REG04, reg04()->raw);
+
+    if (this->seekInterruptPin >= 0 && this->seekInterruptPin == this->rdsInterruptPin)
+    {
+        pinMode(this->seekInterruptPin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(this->seekInterruptPin), (void (*)())pgm_read_ptr(&handlers[2]), FALLING);
+        return;
+    }
+    if (this->seekInterruptPin >= 0)
+    {
+        pinMode(this->seekInterruptPin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(this->seekInterruptPin), (void (*)())pgm_read_ptr(&handlers[0]), FALLING);
+    }
+    if (this->rdsInterruptPin >= 0)
+    {
+        pinMode(this->rdsInterruptPin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(this->rdsInterruptPin), (void (*)())pgm_read_ptr(&handlers[1]), FALLING);
+    }
+}
+
+/**
+ * @ingroup GA03
+ * @brief Detaches the ISRs of this receiver and frees its slot
+ */
+void BK108X::releaseInterrupts()
+{
+    if (this->interruptSlot < 0)
+        return;
+    if (this->seekInterruptPin >= 0)
+        detachInterrupt(digitalPinToInterrupt(this->seekInterruptPin));
+    if (this->rdsInterruptPin >= 0 && this->rdsInterruptPin != this->seekInterruptPin)
+        detachInterrupt(digitalPinToInterrupt(this->rdsInterruptPin));
+    noInterrupts();
+    interruptOwners[this->interruptSlot] = NULL;
+    interrupts();
+    this->interruptSlot = -1;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Frees the interrupt slot, so the ISRs do not write to a receiver that does not exist anymore
+ */
+BK108X::~BK108X()
+{
+    releaseInterrupts();
+}
+
+/**
+ * @ingroup GA03
+ * @brief Checks if it is worth reading the status register
+ * @details Without interrupt pin, it always returns true (polling). With interrupt pin, returns true only 
+ * @details if the device signaled the event (the flag is cleared) or BK_IRQ_FALLBACK_POLL ms have passed since the last read. 
+ * @details In the low power mode (see setLowPower), the RDS fallback read moves to the low power status period.
+ * @param flag  BK_IRQ_STC or BK_IRQ_RDS
+ * @param pin   interrupt pin used by the event
+ * @return true if the status register has to be read
+ */
+bool BK108X::hasInterrupt(uint8_t flag, int pin)
+{
+    if (pin < 0)
+        return true;
+
+    if (interruptFlags & flag)
+    {
+        noInterrupts();
+        interruptFlags &= ~flag;
+        interrupts();
+        this->lastStatusPoll = millis();
+        return true;
+    }
+    uint16_t fallback = (this->lowPower && flag == BK_IRQ_RDS) ? this->lowPowerPeriod : BK_IRQ_FALLBACK_POLL;
+    if ((millis() - this->lastStatusPoll) >= fallback)
+    {
+        this->lastStatusPoll = millis();
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Sets the receiver to FM mode
+ * @details Configures the receiver on FM mode; Also sets the band limits, defaul frequency and step.
+ * 
+ * @param minimum_frequency  minimum frequency for the band
+ * @param maximum_frequency  maximum frequency for the band
+ * @param default_frequency  default freuency
  * @param step  increment and decrement frequency step in KHz (default 10 * 10KHz)
  */
 void BK108X::setFM(uint16_t minimum_frequency, uint16_t maximum_frequency, uint16_t default_frequency, uint16_t step)
@@ -479,13 +1593,15 @@ void BK108X::setFM(uint16_t minimum_frequency, uint16_t maximum_frequency, uint1
     this->maximumFrequency = maximum_frequency;
     this->currentMode = MODE_FM;
 
-    reg07->refined.MODE = MODE_FM;
-    setRegister(REG07, reg07->raw);
-    delay(50);
+    // MODE is written and settles before BAND and SPACE (not batched)
+    reg07()->refined.MODE = MODE_FM;
+    setRegister(REG07, reg07()->raw);
+    waitMs(50);
     // Sets BAND, SPACE and other parameters
-    this->currentFMBand =  reg05->refined.BAND = 0;
-    this->currentFMSpace = reg05->refined.SPACE = 2;
-    setRegister(REG05, reg05->raw);
+    this->currentFMBand =  reg05()->refined.BAND = 0;
+    this->currentFMSpace = reg05()->refined.SPACE = 2;
+    setRegister(REG05, reg05()->raw);
+    updateBandCache();
     setFrequency(default_frequency);
 };
 
@@ -506,21 +1622,23 @@ void BK108X::setAM(uint16_t minimum_frequency, uint16_t maximum_frequency, uint1
     this->minimumFrequency = minimum_frequency;
     this->maximumFrequency = maximum_frequency;
 
-    this->currentMode =  reg07->refined.MODE = MODE_AM;
-    setRegister(REG07, reg07->raw);
-    delay(50);
+    // MODE is written and settles before BAND and SPACE (not batched)
+    this->currentMode =  reg07()->refined.MODE = MODE_AM;
+    setRegister(REG07, reg07()->raw);
+    waitMs(50);
     // Sets BAND, SPACE and other parameters
 
     if (minimum_frequency < 520 )
-        this->currentAMBand = reg05->refined.BAND = 0;  // LW
+        this->currentAMBand = reg05()->refined.BAND = 0;  // LW
     else if (minimum_frequency < 1800)
-        this->currentAMBand = reg05->refined.BAND = 1;  // MW
+        this->currentAMBand = reg05()->refined.BAND = 1;  // MW
     else
-        this->currentAMBand = reg05->refined.BAND = 2;  // SW
+        this->currentAMBand = reg05()->refined.BAND = 2;  // SW
 
-    this->currentAMSpace = reg05->refined.SPACE = am_space;    // Space default value 0 (0=1KHz; 1 = 5KHz; 2=9KHz; 3 = 10KHz)
+    this->currentAMSpace = reg05()->refined.SPACE = am_space;    // Space default value 0 (0=1KHz; 1 = 5KHz; 2=9KHz; 3 = 10KHz)
+    updateBandCache();
 
-    setRegister(REG05, reg05->raw);
+    setRegister(REG05, reg05()->raw);
     this->setFrequency(default_frequency);
 }
 
@@ -532,43 +1650,42 @@ void BK108X::setAM(uint16_t minimum_frequency, uint16_t maximum_frequency, uint1
  */
 void BK108X::setChannel(uint16_t channel)
 {
-    reg02->refined.SEEK = 0;
-    setRegister(REG02,reg02->raw);
-
-    reg03->refined.TUNE = 1;
-    reg03->refined.CHAN = channel;
-
-    setRegister(REG03,reg03->raw);
-    // delay(50);
+    startTuneChannel(channel);
     waitAndFinishTune();
-
-    this->currentChannel = channel;
 }
 
 /**
  * @ingroup GA03
  * @brief Sets the FM frequency 
- * @details ....
+ * @details Tunes the frequency and waits for the device to complete it. See startTune for the non-blocking version.
+ * @see startTune
  * @param frequency  
  */
 void BK108X::setFrequency(uint16_t frequency)
 {
-    uint16_t channel;
-
-    if (this->currentMode == MODE_FM) {
-        channel = (frequency - this->fmStartBand[this->currentFMBand]) /  this->fmSpace[this->currentFMSpace];
-    }
-    else {
-        channel = (frequency - this->amStartBand[this->currentAMBand]) / this->amSpace[this->currentAMSpace];
-    }
+    startTune(frequency);
+    waitAndFinishTune();
+}
 
-    this->setChannel(channel);
+/**
+ * @ingroup GA03
+ * @brief Tunes the target frequency (currentFrequency) set by setFrequencyUp or setFrequencyDown
+ * @details In tune target mode, the tune is only started if no tune is in progress (pollTune tunes the latest 
+ * @details target when the tune in progress completes).
+ */
+void BK108X::tuneTarget()
+{
+    if (!this->tuneTargetMode)
+        setFrequency(this->currentFrequency);
+    else if (!isTuning())
+        startTune(this->currentFrequency);
 }
 
 /**
  * @ingroup GA03
  * @brief Increments the current frequency
  * @details The increment uses the band space as step. 
+ * @details In tune target mode, it returns without waiting for the device (see setTuneTargetMode).
  */
 void BK108X::setFrequencyUp()
 {
@@ -577,13 +1694,14 @@ void BK108X::setFrequencyUp()
     if (this->currentFrequency > this->maximumFrequency ) 
         this->currentFrequency = this->minimumFrequency;
 
-    setFrequency(this->currentFrequency);
+    tuneTarget();
 }
 
 /**
  * @ingroup GA03
  * @brief Decrements the current frequency
  * @details The drecrement uses the band space as step.
+ * @details In tune target mode, it returns without waiting for the device (see setTuneTargetMode).
  */
 void BK108X::setFrequencyDown()
 {
@@ -592,7 +1710,7 @@ void BK108X::setFrequencyDown()
     if (this->currentFrequency < this->minimumFrequency)
         this->currentFrequency = this->maximumFrequency;
 
-    setFrequency(this->currentFrequency);
+    tuneTarget();
 }
 
 /**
@@ -624,7 +1742,7 @@ uint16_t BK108X::getChannel()
 uint16_t BK108X::getRealChannel()
 {
     getRegister(REG0B);
-    return reg0b->refined.READCHAN;
+    return reg0b()->refined.READCHAN;
 }
 
 /**
@@ -636,17 +1754,63 @@ uint16_t BK108X::getRealChannel()
  */
 uint16_t BK108X::getRealFrequency()
 {
-    if (currentMode == MODE_AM) {
-        return getRealChannel() * this->amSpace[this->currentAMSpace] + this->amStartBand[this->currentAMBand];
-    } else {
-        return getRealChannel() * this->fmSpace[this->currentFMSpace] + this->fmStartBand[this->currentFMBand];
-    }  
+    return channelToFrequency(getRealChannel());
+}
+
+/**
+ * @ingroup GA03
+ * @brief Converts a channel of the current band and space to frequency
+ * @param channel 
+ * @return frequency (10kHz unit on FM; kHz on AM) 
+ */
+uint16_t BK108X::channelToFrequency(uint16_t channel)
+{
+    return channel * this->bandSpace + this->bandStart;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Converts a frequency to the channel of the current band and space
+ * @details Uses the cached reciprocal of the channel space instead of a division (see updateBandCache).
+ * @param frequency  (10kHz unit on FM; kHz on AM)
+ * @return channel
+ */
+uint16_t BK108X::frequencyToChannel(uint16_t frequency)
+{
+    uint16_t offset = frequency - this->bandStart;
+
+    if (this->bandReciprocal == 0)
+        return offset;
+    // Same as offset / bandSpace for every offset inside the bands (the largest is 19550: SW with 5kHz space)
+    return ((uint32_t)offset * this->bandReciprocal) >> 18;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Caches the limits and the channel space of the current mode, band and space
+ * @details Called whenever the mode, band or space changes. It keeps flash reads and the division out of
+ * @details channelToFrequency and frequencyToChannel.
+ */
+void BK108X::updateBandCache()
+{
+    if (this->currentMode == MODE_AM)
+    {
+        this->bandStart = pgm_read_word(&amStartBand[this->currentAMBand & 3]);
+        this->bandEnd = pgm_read_word(&amEndBand[this->currentAMBand & 3]);
+        this->bandSpace = pgm_read_word(&amSpace[this->currentAMSpace & 3]);
+    }
+    else
+    {
+        this->bandStart = pgm_read_word(&fmStartBand[this->currentFMBand & 3]);
+        this->bandEnd = pgm_read_word(&fmEndBand[this->currentFMBand & 3]);
+        this->bandSpace = pgm_read_word(&fmSpace[this->currentFMSpace & 3]);
+    }
+    this->bandReciprocal = (this->bandSpace > 1) ? (uint16_t)((262144UL + this->bandSpace - 1) / this->bandSpace) : 0;
 }
 
 
 
 /**
- * @todo it is not working properly
  * @ingroup GA03
  * @brief Seeks a station via Software 
  * @details Seeks a station up or down.
@@ -656,6 +1820,7 @@ uint16_t BK108X::getRealFrequency()
  * @details Seek performance for 50 kHz channel spacing varies according to RCLK tolerance. Silicon Laboratories recommends ±50 ppm RCLK crystal tolerance for 50 kHz seek performance.
  * @details A seek operation may be aborted by setting SEEK = 0.
  * @details It is important to say you have to implement a show frequency function. This function have to get the frequency via getFrequency function.  
+ * @details This function blocks until the seek finishes or the seek timeout (see setSeekTimeout) expires. See startSeek for the non-blocking version.
  * @details Example:
  * @code
  * 
@@ -670,7 +1835,7 @@ uint16_t BK108X::getRealFrequency()
  * void loop() {
  *  .
  *  .
- *      rx.seek(BK_SEEK_WRAP, BK_SEEK_UP, showFrequency); // Seek Up
+ *      rx.seekSoftware(BK_SEEK_WRAP, BK_SEEK_UP, showFrequency); // Seek Up
  *  .
  *  .
  * }
@@ -681,73 +1846,528 @@ uint16_t BK108X::getRealFrequency()
  */
 void BK108X::seekSoftware(uint8_t seek_mode, uint8_t direction, void (*showFunc)())
 {
-    long max_time = millis();
+    void (*callback)() = this->seekCallback;
 
-    // reg06->refined.SKSNR = 9;
-    // setRegister(REG06,reg06->raw);
+    this->seekCallback = showFunc;
+    startSeek(seek_mode, direction);
+    while (pollSeek() == BK_SEEK_IN_PROGRESS)
+        waitMs(1);
+    this->seekCallback = callback;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Seeks a station via hardware functionality 
+ * @details Blocks until the seek finishes or the seek timeout (see setSeekTimeout) expires. See startSeek for the non-blocking version.
+ * 
+ * @param seek_mode  Seek Mode; 0 = Wrap at the upper or lower band limit and continue seeking (default); 1 = Stop seeking at the upper or lower band limit.
+ * @param direction  Seek Direction; 0 = Seek down (default); 1 = Seek up.
+ */
+void BK108X::seekHardware(uint8_t seek_mode, uint8_t direction) {
 
-    reg03->refined.TUNE = 0;
-    setRegister(REG03, reg03->raw);
-    delay(50);
+    startSeek(seek_mode, direction);
+    while (pollSeek() == BK_SEEK_IN_PROGRESS)
+        waitMs(1);
+}
 
-    do
+/**
+ * @ingroup GA03
+ * @brief Starts a seek and returns immediately
+ * @details Call pollSeek in your loop to follow and complete the seek. 
+ * @code
+ * rx.setSeekCallback(showFrequency);  // optional: shows the frequency during the seek
+ * rx.startSeek(BK_SEEK_WRAP, BK_SEEK_UP);
+ * .
+ * .
+ * void loop() {
+ *   uint8_t status = rx.pollSeek();
+ *   if (status == BK_SEEK_FOUND) 
+ *      showStation();
+ *   // Other tasks 
+ * }
+ * @endcode
+ * @see pollSeek, cancelSeek, setSeekCallback, setSeekTimeout
+ * @param seek_mode  Seek Mode; 0 = Wrap at the upper or lower band limit and continue seeking (default); 1 = Stop seeking at the upper or lower band limit.
+ * @param direction  Seek Direction; 0 = Seek down (default); 1 = Seek up.
+ */
+void BK108X::startSeek(uint8_t seek_mode, uint8_t direction)
+{
+    if (reg03()->refined.TUNE)
     {
-        reg02->refined.SKMODE = seek_mode;
-        reg02->refined.SEEKUP = direction;
-        reg02->refined.SEEK = 1;
-        setRegister(REG02, reg02->raw);
-        delay(50);
-        if (showFunc != NULL)
-        {
-            this->currentFrequency = getRealFrequency();
-            showFunc();                                    
-        }
-        getRegister(REG0A);
-    } while ( (!reg0a->refined.STC && reg0a->refined.SF_BL)  && (millis() - max_time) < MAX_SEEK_TIME);
+        reg03()->refined.TUNE = 0;
+        setRegister(REG03, reg03()->raw);
+    }
+    this->tuneState = BK_TUNE_IDLE;
+    abortAf();
+
+    reg02()->refined.SKMODE = seek_mode;
+    reg02()->refined.SEEKUP = direction;
+    reg02()->refined.SKAFCRL = 1;
+    reg02()->refined.SEEK = 1;
+    setRegister(REG02, reg02()->raw);
+
+    reg0a()->refined.STC = 0;
+    this->seekStartTime = this->lastStatusPoll = millis();
+    startStcPolling(BK_STC_POLL_SEEK_MAX, BK_STC_POLL_MIN);
+    this->seekChecking = false;
+    this->signalQualityValid = false;
+    clearRdsBuffer();
+    this->seekState = BK_SEEK_IN_PROGRESS;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Follows and completes the seek started by startSeek
+ * @details Reads the status (0x0A) and READCHAN (0x0B) registers in a single transaction, updates the current frequency 
+ * @details with the channel being checked by the device and calls the seek callback. 
+ * @details If seekInterruptPin is set, the registers are read only after the device signals or every BK_IRQ_FALLBACK_POLL ms.
+ * @details Otherwise, the reads are paced by the adaptive STC polling (see isStcPollDue).
+ * @details If the seek validation is enabled (see setSeekValidation), each stop is sampled before BK_SEEK_FOUND is
+ * @details returned, and the seek continues from a rejected stop.
+ * @see startSeek, cancelSeek
+ * @return BK_SEEK_IN_PROGRESS; BK_SEEK_FOUND, BK_SEEK_FAIL or BK_SEEK_TIMEOUT once, when the seek finishes; BK_SEEK_IDLE otherwise.
+ */
+uint8_t BK108X::pollSeek()
+{
+    if (this->seekState != BK_SEEK_IN_PROGRESS)
+        return BK_SEEK_IDLE;
+    BK_STATS(this->stats.seekPolls++);
+
+    if ((millis() - this->seekStartTime) > this->seekTimeout)
+    {
+        readRegisters(REG0A, 2, NULL);
+        finishSeek();
+        return BK_SEEK_TIMEOUT;
+    }
+
+    if (this->seekChecking)
+        return checkSeekStop();
+
+    if (!isStcPollDue())
+        return BK_SEEK_IN_PROGRESS;
+
+    if (!readRegisters(REG0A, 2, NULL))
+    {
+        finishSeek();
+        return BK_SEEK_ERROR;
+    }
+    if (reg0a()->refined.STC == 0)
+    {
+        this->currentFrequency = channelToFrequency(reg0b()->refined.READCHAN);
+        if (this->seekCallback != NULL)
+            this->seekCallback();
+        return BK_SEEK_IN_PROGRESS;
+    }
+
+    if (!reg0a()->refined.SF_BL && this->seekCheckSamples)
+    {
+        this->currentFrequency = channelToFrequency(reg0b()->refined.READCHAN);
+        this->seekChecking = true;
+        this->seekCheckCount = this->seekCheckStereo = 0;
+        this->seekCheckRssi = this->seekCheckSnr = 0;
+        this->seekCheckNext = millis();
+        return checkSeekStop();
+    }
+
+    uint8_t result = (reg0a()->refined.SF_BL) ? BK_SEEK_FAIL : BK_SEEK_FOUND;
+    finishSeek();
+    return result;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Samples the channel where the seek stopped and accepts or rejects it
+ * @details Takes one sample of RSSI, SNR (0x09) and the stereo pilot (0x0A) in a single transaction when it is due.
+ * @details After the last sample, the averages are compared with the thresholds of the current mode and band
+ * @details (see setSeekValidationThreshold). A rejected stop is stored as the new seek start and the seek goes on.
+ * @return BK_SEEK_FOUND if the stop is valid, BK_SEEK_ERROR on a bus error or BK_SEEK_IN_PROGRESS
+ */
+uint8_t BK108X::checkSeekStop()
+{
+    if ((int32_t)(millis() - this->seekCheckNext) < 0)
+        return BK_SEEK_IN_PROGRESS;
+
+    if (!readRegisters(REG09, 2, NULL))
+    {
+        finishSeek();
+        return BK_SEEK_ERROR;
+    }
+    this->seekCheckRssi += reg0a()->refined.RSSI;
+    this->seekCheckSnr += reg09()->refined.SNR;
+    this->seekCheckStereo += reg0a()->refined.STEN;
+    if (++this->seekCheckCount < this->seekCheckSamples)
+    {
+        this->seekCheckNext = millis() + this->seekCheckInterval;
+        return BK_SEEK_IN_PROGRESS;
+    }
+
+    bk_seek_check *check = &this->seekChecks[(this->currentMode << 2) | (reg05()->refined.BAND & 3)];
+    uint8_t n = this->seekCheckCount;
+    this->seekChecking = false;
+    if (this->seekCheckRssi >= (uint16_t)check->rssi * n && this->seekCheckSnr >= (uint16_t)check->snr * n &&
+        (!check->stereo || this->currentMode != MODE_FM || this->seekCheckStereo * 2 > n))
+    {
+        finishSeek();
+        return BK_SEEK_FOUND;
+    }
 
-    reg02->refined.SEEK = 0;
-    reg03->refined.TUNE = 0;
-    setRegister(REG02, reg02->raw);
-    setRegister(REG03, reg03->raw);
+    // Rejected: the device seeks again from this channel (SEEK 0 -> 1).
+    BK_STATS(this->stats.seekRejects++);
+    clearSeek();
+    reg02()->refined.SEEK = 1;
+    setRegister(REG02, reg02()->raw);
+    reg0a()->refined.STC = 0;
+    startStcPolling(BK_STC_POLL_SEEK_MAX, BK_STC_POLL_MIN);
+    if (this->seekCallback != NULL)
+        this->seekCallback();
+    return BK_SEEK_IN_PROGRESS;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Stops the seek started by startSeek
+ * @details The receiver stays on the channel the device was checking.
+ */
+void BK108X::cancelSeek()
+{
+    if (this->seekState != BK_SEEK_IN_PROGRESS)
+        return;
+    readRegisters(REG0A, 2, NULL);
+    finishSeek();
+}
+
+/**
+ * @ingroup GA03
+ * @brief Stops the device seek on the current channel
+ * @details Clears SEEK and stores the READCHAN channel with TUNE = 0 via a single transaction (registers 0x02 and 0x03).
+ * @details The receiver is already on that channel. So, it does not need to be tuned again.
+ * @return the channel
+ */
+uint16_t BK108X::clearSeek()
+{
+    uint16_t channel = reg0b()->refined.READCHAN;
+
+    reg02()->refined.SEEK = 0;
+    reg03()->refined.TUNE = 0;
+    reg03()->refined.CHAN = channel;
+    writeRegisters(REG02, 2, &shadowRegisters[REG02]);
+    return channel;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Finishes the seek process
+ * @details Stops the device seek (see clearSeek) and makes the READCHAN channel the current channel.
+ */
+void BK108X::finishSeek()
+{
+    uint16_t channel = clearSeek();
+
+    this->seekChecking = false;
+    BK_STATS(statsLatency(this->stats.seekLatency, this->stats.seekMax, this->seekStartTime));
+    this->currentChannel = channel;
+    this->currentFrequency = channelToFrequency(channel);
+    this->seekState = BK_SEEK_IDLE;
+    this->signalQualityValid = false;
+    if (this->seekCallback != NULL)
+        this->seekCallback();
+}
+
+/**
+ * @ingroup GA03
+ * @brief Scans the whole band and builds the station table
+ * @details Walks the current band (from the minimum to the maximum frequency set by setFM or setAM, limited to the 
+ * @details band limits), using the active space. The first channel is tuned and sampled. Then the device seeks up, 
+ * @details with the scan threshold (see setScanThreshold) as seek threshold, and each stop is sampled: a channel 
+ * @details without a station costs only a device seek step, not a full tune and status read.
+ * @details The channels with RSSI and SNR above the scan threshold are stored.
+ * @details If more than BK_SCAN_MAX_STATIONS stations are found, the weakest ones are dropped.
+ * @details At the end, the seek thresholds are restored and the receiver goes back to the channel it was tuned 
+ * @details before the scan.
+ * @details This function blocks until the scan finishes. See startScan for the incremental version.
+ * @code
+ * uint8_t n = rx.scanBand();
+ * for (uint8_t i = 0; i < n; i++) {
+ *    Serial.print(rx.getScanFrequency(i));
+ *    Serial.print(" RSSI: ");
+ *    Serial.println(rx.getScanStation(i)->rssi);
+ * }
+ * @endcode
+ * @see startScan, pollScan, setScanThreshold, getScanCount, getScanStation, getScanFrequency
+ * @return number of stations found
+ */
+uint8_t BK108X::scanBand()
+{
+    startScan();
+    while (pollScan() == BK_SCAN_IN_PROGRESS)
+        waitMs(1);
+    if (isTuning())
+        waitAndFinishTune(); // Back to the channel tuned before the scan
+    return this->scanCount;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Starts a band scan and returns immediately
+ * @details Call pollScan in your loop. Each call does at most one step of the scan.
+ * @code
+ * rx.startScan();
+ * .
+ * .
+ * void loop() {
+ *   if (rx.pollScan() == BK_SCAN_DONE)
+ *      showStations();
+ *   // Other tasks 
+ * }
+ * @endcode
+ * @see scanBand, pollScan, cancelScan
+ */
+void BK108X::startScan()
+{
+    startScan(this->minimumFrequency, this->maximumFrequency);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Starts the scan of a part of the band and returns immediately
+ * @details Same as startScan, but from minimum_frequency to maximum_frequency (limited to the band limits).
+ * @details Useful to share a band among some receivers (see BK108XGroup).
+ * @param minimum_frequency  first frequency to be sampled
+ * @param maximum_frequency  last frequency to be sampled
+ */
+void BK108X::startScan(uint16_t minimum_frequency, uint16_t maximum_frequency)
+{
+    uint16_t minimum = this->bandStart;
+    uint16_t maximum = this->bandEnd;
+
+    if (minimum_frequency > minimum && minimum_frequency <= maximum)
+        minimum = minimum_frequency;
+    if (maximum_frequency < maximum && maximum_frequency >= minimum)
+        maximum = maximum_frequency;
+
+    if (this->seekState == BK_SEEK_IN_PROGRESS)
+        cancelSeek();
+    cancelScan();
+
+    this->scanSavedChannel = this->currentChannel;
+    this->scanChannel = frequencyToChannel(minimum);
+    this->scanLastChannel = frequencyToChannel(maximum);
+    this->scanCount = 0;
+    this->scanSeekRssi = reg05()->refined.SEEKTH;
+    this->scanSeekSnr = reg06()->refined.SKSNR;
+    setScanSeekThreshold((this->scanRssi > 127) ? 127 : this->scanRssi, (this->scanSnr > 127) ? 127 : this->scanSnr);
+    this->scanSeeking = false;
+    this->scanState = BK_SCAN_IN_PROGRESS;
+    startTuneChannel(this->scanChannel);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Sets the device seek thresholds (SEEKTH and SKSNR) in a single transaction (registers 0x05 and 0x06)
+ */
+void BK108X::setScanSeekThreshold(uint8_t rssiValue, uint8_t snrValue)
+{
+    reg05()->refined.SEEKTH = rssiValue;
+    reg06()->refined.SKSNR = snrValue;
+    writeRegisters(REG05, 2, &shadowRegisters[REG05]);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Starts the device seek to the next station of the scan
+ * @details Seeks up and stops at the band limit. SEEK has to go from 0 to 1: after a stop, it is cleared first 
+ * @details (see clearSeek).
+ */
+void BK108X::startScanSeek()
+{
+    if (reg02()->refined.SEEK)
+        clearSeek();
+    reg02()->refined.SKMODE = BK_SEEK_STOP;
+    reg02()->refined.SEEKUP = BK_SEEK_UP;
+    reg02()->refined.SKAFCRL = 1;
+    reg02()->refined.SEEK = 1;
+    setRegister(REG02, reg02()->raw);
+
+    reg0a()->refined.STC = 0;
+    this->tuneStartTime = this->lastStatusPoll = millis();
+    startStcPolling(BK_STC_POLL_SEEK_MAX, BK_STC_POLL_MIN);
+    this->scanSeeking = true;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Does one step of the scan started by startScan
+ * @details Checks STC of the first channel or of the device seek. The SNR (0x09), the RSSI / stereo status (0x0A) 
+ * @details and READCHAN (0x0B) are read in a single transaction. On STC, the channel is sampled and the seek to the 
+ * @details next station is started. The scan ends at the band limit (SF_BL) or when READCHAN goes past the last 
+ * @details channel of the scan.
+ * @details If seekInterruptPin is set, the status is read only after the device signals or every BK_IRQ_FALLBACK_POLL ms.
+ * @details Otherwise, the reads are paced by the adaptive STC polling (see isStcPollDue).
+ * @details When the scan finishes, the tune back to the channel tuned before the scan is started. Call pollTune 
+ * @details (or tick) to complete it.
+ * @see startScan, scanBand
+ * @return BK_SCAN_IN_PROGRESS; BK_SCAN_DONE once, when the scan finishes; BK_SCAN_IDLE otherwise.
+ */
+uint8_t BK108X::pollScan()
+{
+    if (this->scanState != BK_SCAN_IN_PROGRESS)
+        return BK_SCAN_IDLE;
+    BK_STATS(this->stats.scanPolls++);
+
+    if (!isStcPollDue())
+        return BK_SCAN_IN_PROGRESS;
+
+    bool timeout = (millis() - this->tuneStartTime) > ((this->scanSeeking) ? this->seekTimeout : this->tuneTimeout);
+    if (!readRegisters(REG09, 3, NULL) || (timeout && reg0a()->refined.STC == 0))
+    {
+        // Bus error or no STC: the scan ends here (the stations found so far are kept)
+        if (timeout)
+            this->busErrors.timeouts++;
+        cancelScan();
+        return BK_SCAN_DONE;
+    }
+    if (this->scanSeeking && (reg0b()->refined.READCHAN > this->scanLastChannel || (reg0a()->refined.STC && reg0a()->refined.SF_BL)))
+    {
+        // Past the last channel of the scan, or band limit reached without a station
+        cancelScan();
+        return BK_SCAN_DONE;
+    }
+    if (reg0a()->refined.STC == 0)
+        return BK_SCAN_IN_PROGRESS;
+
+    if (this->scanSeeking)
+        this->scanChannel = reg0b()->refined.READCHAN;
+    else
+    {
+        BK_STATS(statsLatency(this->stats.tuneLatency, this->stats.tuneMax, this->tuneStartTime));
+        learnStcLatency();
+        reg03()->refined.TUNE = 0;
+        setRegister(REG03, reg03()->raw);
+    }
+    addScanStation();
+
+    if (this->scanChannel < this->scanLastChannel)
+    {
+        startScanSeek();
+        return BK_SCAN_IN_PROGRESS;
+    }
+
+    cancelScan();
+    return BK_SCAN_DONE;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Stops the scan started by startScan
+ * @details The stations found so far are kept, the seek thresholds are restored and the receiver goes back to the 
+ * @details channel it was tuned before the scan (a device seek in progress is stopped by that tune).
+ * @details That tune is not waited for: it is completed by pollTune (or tick), like a startTune.
+ */
+void BK108X::cancelScan()
+{
+    if (this->scanState != BK_SCAN_IN_PROGRESS)
+        return;
+    this->scanState = BK_SCAN_IDLE;
+    this->scanSeeking = false;
+    setScanSeekThreshold(this->scanSeekRssi, this->scanSeekSnr);
+    this->tuneState = BK_TUNE_IDLE;
+    this->currentFrequency = channelToFrequency(this->scanSavedChannel);
+    startTuneChannel(this->scanSavedChannel);
+}
+
+/**
+ * @ingroup GA03
+ * @brief Stores the channel being sampled in the station table if it is a valid station
+ * @details When the table is full, the weakest station is dropped (the table is kept sorted by channel).
+ */
+void BK108X::addScanStation()
+{
+    if (reg0a()->refined.RSSI < this->scanRssi || reg09()->refined.SNR < this->scanSnr)
+        return;
+
+    if (this->scanCount == BK_SCAN_MAX_STATIONS)
+    {
+        uint8_t weakest = 0;
+        for (uint8_t i = 1; i < this->scanCount; i++)
+            if (this->scanStations[i].rssi < this->scanStations[weakest].rssi)
+                weakest = i;
+        if (this->scanStations[weakest].rssi >= reg0a()->refined.RSSI)
+            return;
+        memmove(&this->scanStations[weakest], &this->scanStations[weakest + 1], (this->scanCount - weakest - 1) * sizeof(bk_scan_station));
+        this->scanCount--;
+    }
 
-    this->currentFrequency = getRealFrequency();
+    bk_scan_station *station = &this->scanStations[this->scanCount++];
+    station->channel = this->scanChannel;
+    station->stereo = reg0a()->refined.STEN;
+    station->rssi = reg0a()->refined.RSSI;
+    station->snr = reg09()->refined.SNR;
 }
 
 /**
- * @todo make it work. 
  * @ingroup GA03
- * @brief Seeks a station via hardware functionality 
- * 
- * @param seek_mode  Seek Mode; 0 = Wrap at the upper or lower band limit and continue seeking (default); 1 = Stop seeking at the upper or lower band limit.
- * @param direction  Seek Direction; 0 = Seek down (default); 1 = Seek up.
+ * @brief Reads the receiver status once and reports what changed since the last call
+ * @details Reads the registers 0x09 to 0x0F (SNR, status, channel and RDS blocks) in a single transaction, queues 
+ * @details and decodes a new RDS group (see captureRds and processRds), refreshes the status snapshot (see 
+ * @details getSignalQuality) and compares the results with the values 
+ * @details reported by the previous call. The values are available without new I2C transactions via getUpdatedRssi, 
+ * @details getUpdatedSnr, isUpdatedStereo, getFrequency and the RDS text functions.
+ * @details If the update callback is set (see setUpdateCallback), it is called when something changed.
+ * @code
+ * void loop() {
+ *   uint8_t changed = rx.update();
+ *   if (changed & BK_CHANGED_FREQUENCY) showFrequency();
+ *   if (changed & (BK_CHANGED_RSSI | BK_CHANGED_SNR)) showRSSI();
+ *   if (changed & BK_CHANGED_STEREO) showStereo();
+ *   if (changed & BK_CHANGED_RDS_PS) showStationName();
+ *   .
+ *   .
+ * }
+ * @endcode
+ * @see setUpdateCallback, setUpdateResolution
+ * @return BK_CHANGED_* flags (0 if nothing changed or if the transaction failed, see getBusErrors)
  */
-void BK108X::seekHardware(uint8_t seek_mode, uint8_t direction) {
-
-    reg03->refined.TUNE = 0;
-    setRegister(REG03, reg03->raw);
-
-    reg02->refined.SKMODE = seek_mode;
-    reg02->refined.SEEKUP = direction;
-    reg02->refined.SKAFCRL = 1;
+uint8_t BK108X::update()
+{
+    uint8_t changed, value;
 
+    if (!readRegisters(REG09, REG0F - REG09 + 1, NULL)) // Registers 0x09 to 0x0F in a single transaction
+        return 0; // Nothing is compared with stale registers. The next call reports the changes.
+    storeSignalQuality();
+    if (this->signalQuality.rdsReady)
+        queueRdsGroup();
+    processRds();
 
-    do {
-        reg02->refined.SEEK = 1;
-        setRegister(REG02, reg02->raw);
-        delay(40);
-        while (reg0a->refined.STC == 0 )
-        {
-            delay(10);
-            getRegister(REG0A);
-        }
-    } while ( reg0a->refined.SF_BL != 0 );
+    changed = this->rdsChanged;
+    this->rdsChanged = 0;
 
-    reg02->refined.SEEK = 0;
-    setRegister(REG02, reg02->raw);
-    delay(50);
+    if (this->currentFrequency != this->updateFrequency)
+    {
+        this->updateFrequency = this->currentFrequency;
+        changed |= BK_CHANGED_FREQUENCY;
+    }
+    value = this->signalQuality.rssi / this->updateRssiStep;
+    if (value != this->updateRssi)
+    {
+        this->updateRssi = value;
+        changed |= BK_CHANGED_RSSI;
+    }
+    value = this->signalQuality.snr / this->updateSnrStep;
+    if (value != this->updateSnr)
+    {
+        this->updateSnr = value;
+        changed |= BK_CHANGED_SNR;
+    }
+    value = this->signalQuality.stereo;
+    if (value != this->updateStereo)
+    {
+        this->updateStereo = value;
+        changed |= BK_CHANGED_STEREO;
+    }
 
-    this->setChannel(this->getRealChannel());
-    this->currentFrequency = getRealFrequency();
+    if (changed && this->updateCallback != NULL)
+        this->updateCallback(changed);
+    return changed;
 }
 
 /**
@@ -759,11 +2379,13 @@ void BK108X::seekHardware(uint8_t seek_mode, uint8_t direction) {
  */
 void BK108X::setSeekThreshold(uint8_t rssiValue, uint8_t snrValue)
 {
-    reg05->refined.SEEKTH = rssiValue;
-    setRegister(REG05,reg05->raw);
+    beginUpdate();
+    reg05()->refined.SEEKTH = rssiValue;
+    setRegister(REG05,reg05()->raw);
 
-    reg06->refined.SKSNR = snrValue;
-    setRegister(REG06,reg06->raw);
+    reg06()->refined.SKSNR = snrValue;
+    setRegister(REG06,reg06()->raw);
+    commit();
 }
 
 /**
@@ -789,8 +2411,10 @@ void BK108X::setBand(uint8_t band)
     else
         this->currentFMBand = band;
 
-    reg05->refined.BAND = band;
-    setRegister(REG05,reg05->raw);
+    updateBandCache();
+
+    reg05()->refined.BAND = band;
+    setRegister(REG05,reg05()->raw);
 }
 
 /**
@@ -813,33 +2437,84 @@ void BK108X::setSpace(uint8_t space)
         this->currentAMSpace = space;
     else 
         this->currentFMSpace = space;
+    updateBandCache();
 
-    reg05->refined.SPACE = space;
-    setRegister(REG05, reg05->raw);
+    reg05()->refined.SPACE = space;
+    setRegister(REG05, reg05()->raw);
 }
 
 /**
  * @ingroup GA03
  * @brief Gets the current Rssi
- * 
+ * @details Served from the status snapshot if it is not older than the status max age (see setStatusMaxAge and
+ * @details setLowPower).
  * @return int 
  */
 int BK108X::getRssi()
 {
-    getRegister(REG0A);
-    return reg0a->refined.RSSI;
+    refreshStatus(getStatusAge());
+    return this->signalQuality.rssi;
 }
 
 /**
  * @ingroup GA03
  * @brief Gets the current SNR
- * 
+ * @details Served from the status snapshot if it is not older than the status max age (see setStatusMaxAge and
+ * @details setLowPower).
  * @return int  The SNR Value.( in dB)
  */
 int BK108X::getSnr()
 {
-    getRegister(REG09);
-    return reg09->refined.SNR;
+    refreshStatus(getStatusAge());
+    return this->signalQuality.snr;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Refreshes the signal quality snapshot
+ * @details Reads the registers 0x09 to 0x0B (SNR, status and READCHAN) in a single transaction if the snapshot is 
+ * @details older than maxAge or was invalidated (tune, seek or invalidateStatus).
+ * @see getSignalQuality, setStatusMaxAge
+ * @param maxAge  maximum age of the snapshot in ms (0 = always read the registers)
+ * @return true if the registers were read; false if the snapshot was served from the cache or the read failed
+ */
+bool BK108X::refreshStatus(uint16_t maxAge)
+{
+    if (maxAge && this->signalQualityValid && (millis() - this->signalQuality.timestamp) < maxAge)
+        return false;
+    if (!readRegisters(REG09, REG0B - REG09 + 1, NULL))
+        return false; // The snapshot and its timestamp are kept (see getBusErrors)
+    storeSignalQuality();
+    return true;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Gets the max age of the snapshot used by getRssi, getSnr and isStereo
+ * @details The status max age (see setStatusMaxAge) or, in the low power mode, the low power status period if longer.
+ */
+uint16_t BK108X::getStatusAge()
+{
+    if (this->lowPower && this->lowPowerPeriod > this->statusMaxAge)
+        return this->lowPowerPeriod;
+    return this->statusMaxAge;
+}
+
+/**
+ * @ingroup GA03
+ * @brief Stores the shadow registers 0x09 to 0x0B in the signal quality snapshot
+ */
+void BK108X::storeSignalQuality()
+{
+    this->signalQuality.rssi = reg0a()->refined.RSSI;
+    this->signalQuality.snr = reg09()->refined.SNR;
+    this->signalQuality.stereo = reg0a()->refined.STEN;
+    this->signalQuality.rdsReady = reg0a()->refined.RDSR;
+    this->signalQuality.stc = reg0a()->refined.STC;
+    this->signalQuality.sfbl = reg0a()->refined.SF_BL;
+    this->signalQuality.readChannel = reg0b()->refined.READCHAN;
+    this->signalQuality.timestamp = millis();
+    this->signalQualityValid = true;
 }
 
 /**
@@ -850,8 +2525,8 @@ int BK108X::getSnr()
  */
 void BK108X::setSoftMute(bool value)
 {
-    reg02->refined.DSMUTE = !value;  // Soft mute TRUE/ENABLE means DSMUTE = 0. 
-    setRegister(REG02,reg02->raw);
+    reg02()->refined.DSMUTE = !value;  // Soft mute TRUE/ENABLE means DSMUTE = 0. 
+    setRegister(REG02,reg02()->raw);
 }
 
 /**
@@ -871,8 +2546,8 @@ void BK108X::setSoftMute(bool value)
  */
 void BK108X::setSoftMuteAttack(uint8_t value)
 {
-    reg06->refined.SMUTER = value;
-    setRegister(REG06,reg06->raw);
+    reg06()->refined.SMUTER = value;
+    setRegister(REG06,reg06()->raw);
 }
 
 /**
@@ -890,8 +2565,8 @@ void BK108X::setSoftMuteAttack(uint8_t value)
  */
 void BK108X::setSoftMuteAttenuation(uint8_t value)
 {
-    reg06->refined.SMUTEA = value;
-    setRegister(REG06, reg06->raw);
+    reg06()->refined.SMUTEA = value;
+    setRegister(REG06, reg06()->raw);
 }
 
 /**
@@ -904,9 +2579,9 @@ void BK108X::setSoftMuteAttenuation(uint8_t value)
  */
 void BK108X::setMuteThreshold(uint8_t rssi, uint8_t snr)
 {
-    reg14->refined.RSSIMTH = rssi;
-    reg14->refined.SNRMTH = snr;
-    setRegister(REG14,reg14->raw);
+    reg14()->refined.RSSIMTH = rssi;
+    reg14()->refined.SNRMTH = snr;
+    setRegister(REG14,reg14()->raw);
 }
 
 /**
@@ -916,8 +2591,8 @@ void BK108X::setMuteThreshold(uint8_t rssi, uint8_t snr)
  * @param value If true, enable mute during the seek;
  */
 void BK108X::setSeekMute(bool value){
-    reg14->refined.SKMUTE = value;
-    setRegister(REG14, reg14->raw);
+    reg14()->refined.SKMUTE = value;
+    setRegister(REG14, reg14()->raw);
 }
 
 /**
@@ -927,8 +2602,8 @@ void BK108X::setSeekMute(bool value){
  * @param value  If true, enable soft mute when AFCRL is high
  */
 void BK108X::setAfcMute(bool value) {
-    reg14->refined.AFCMUTE = value;
-    setRegister(REG14, reg14->raw);
+    reg14()->refined.AFCMUTE = value;
+    setRegister(REG14, reg14()->raw);
 }
 
 
@@ -942,9 +2617,9 @@ void BK108X::setAfcMute(bool value) {
  */
 void BK108X::setAudioMute(bool left, bool right)
 {
-    reg02->refined.MUTEL = left;
-    reg02->refined.MUTER = right;
-    setRegister(REG02, reg02->raw);    
+    reg02()->refined.MUTEL = left;
+    reg02()->refined.MUTER = right;
+    setRegister(REG02, reg02()->raw);    
 }
 
 /**
@@ -966,22 +2641,22 @@ void BK108X::setAudioMute(bool value)
  */
 void BK108X::setMono(bool value)
 {
-  reg02->refined.MONO = value;
-  reg02->refined.STEREO = !value;
-  setRegister(REG02,reg02->raw);  
+  reg02()->refined.MONO = value;
+  reg02()->refined.STEREO = !value;
+  setRegister(REG02,reg02()->raw);  
 }
 
 /**
  * @ingroup GA03
  * @brief Checks stereo / mono status
- * 
+ * @details Served from the status snapshot if it is not older than the status max age (see setStatusMaxAge).
  * @see getStatus
  * @param value TRUE if stereo
  */
 bool BK108X::isStereo()
 {
-    getRegister(REG0A);
-    return reg0a->refined.STEN;
+    refreshStatus(getStatusAge());
+    return this->signalQuality.stereo;
 }
 
 /**
@@ -995,9 +2670,9 @@ void BK108X::setVolume(uint8_t value)
     if ( value > 31) return;
     this->currentVolume = value;
     // reg05 is a shadow register and has the last value read or written from/to the internal device register
-    reg05->refined.VOLUME = value; 
+    reg05()->refined.VOLUME = value; 
 
-    setRegister(REG05,reg05->raw);
+    setRegister(REG05,reg05()->raw);
 }
 
 /**
@@ -1049,13 +2724,302 @@ void BK108X::setVolumeDown()
 /**
  * @ingroup GA04
  * @brief Gets the RDS registers information
- * @details Gets the value of the registers from 0x0A to 0x0F
- * @details This function also updates the value of shadowRegisters[0];
- * @return bk_reg0a 
+ * @details Gets the value of the registers from 0x0A to 0x0F in a single transaction.
+ * @details If a new RDS group is ready (RDSR), the group is queued and all queued groups are decoded into the RDS buffers.
+ * @see getRdsText0A, getRdsText2A, getRdsText2B, getRdsTime, captureRds, processRds
  */
 void BK108X::getRdsStatus()
 {
+    readRegisters(REG0A, REG0F - REG0A + 1, NULL); // Registers 0x0A to 0x0F in a single transaction
+    if (reg0a()->refined.RDSR)
+        queueRdsGroup();
+    processRds();
+}
+
+/**
+ * @ingroup GA04
+ * @brief Captures a new RDS group without decoding it
+ * @details This is the lightweight side of the RDS pipeline: one I2C transaction (registers 0x0A to 0x0F) and a copy 
+ * @details of the raw group to the RDS queue. Call it often (or when the RDS interrupt is signaled) and call processRds 
+ * @details when the loop has time to decode the groups. 
+ * @details If rdsInterruptPin is set, the registers are read only after the device signals a new RDS group (or every 
+ * @details BK_IRQ_FALLBACK_POLL ms). The ISR itself does not use the I2C bus, which may be in use by the main loop.
+ * @details Otherwise, call it at least every 40ms (RDSR keeps high for 40ms and a new group comes every ~88ms).
+ * @code
+ * void loop() {
+ *   rx.captureRds();          // fast: queues the raw group
+ *   updateDisplay();
+ *   if (rx.processRds())      // decodes the queued groups
+ *      showRds();
+ * }
+ * @endcode
+ * @see processRds, getRdsOverflows
+ * @return true if a new group was queued
+ */
+bool BK108X::captureRds()
+{
+    if (!hasInterrupt(BK_IRQ_RDS, this->rdsInterruptPin))
+        return false;
+    readRegisters(REG0A, REG0F - REG0A + 1, NULL); // Registers 0x0A to 0x0F in a single transaction
+    if (!reg0a()->refined.RDSR)
+        return false;
+    return queueRdsGroup();
+}
+
+/**
+ * @ingroup GA04
+ * @brief Decodes the RDS groups queued by captureRds, getRdsReady or getRdsStatus
+ * @details Does not use the I2C bus. 
+ * @param maxGroups maximum number of groups decoded by this call (default: the whole queue)
+ * @return number of groups decoded
+ */
+uint8_t BK108X::processRds(uint8_t maxGroups)
+{
+    bk_rds_data *rds = rdsBuffers();
+    uint8_t n = 0;
+    if (rds == NULL)
+        return 0;
+    while (n < maxGroups && this->rdsQueue->pop(rds->group))
+    {
+        processRdsGroup();
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Queues the RDS group stored in the shadow registers 0x0A to 0x0F
+ * @details A group is not queued if:
+ * @details 1) it is equal to the last one read (the RDSR bit keeps high for 40ms);
+ * @details 2) it is equal to the last one queued for the same group type and segment (see getRdsFingerprint).
+ * @details The BK1088 datasheet documents no RDS block error bits. So, the groups are not filtered by error level.
+ * @return true if the group was queued
+ */
+bool BK108X::queueRdsGroup()
+{
+    bk_rds_group group;
+    bk_rds_data *rds = rdsBuffers();
+
+    this->rdsLastTime = millis();
+    if (rds == NULL)
+        return false;
+    if (memcmp(rds->lastGroup, &shadowRegisters[REG0C], sizeof(rds->lastGroup)) == 0)
+        return false;
+    memcpy(rds->lastGroup, &shadowRegisters[REG0C], sizeof(rds->lastGroup));
+
+    copyRdsGroup(group);
+
+    uint16_t fingerprint;
+    uint8_t slot = getRdsFingerprint(group, fingerprint);
+    if (slot < BK_RDS_FINGERPRINTS && rds->fingerprint[slot] == fingerprint)
+    {
+        this->rdsDuplicateDrops++;
+        return false;
+    }
+    if (!this->rdsQueue->push(group))
+        return false;
+    if (slot < BK_RDS_FINGERPRINTS)
+        rds->fingerprint[slot] = fingerprint; // Only groups really queued (not dropped by overflow)
+    return true;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Copies the RDS group stored in the shadow registers 0x0A to 0x0F
+ * @param group  blocks A to D and the status registers 0x0A and 0x0B
+ */
+void BK108X::copyRdsGroup(bk_rds_group &group)
+{
+    memcpy(group.block, &shadowRegisters[REG0C], sizeof(group.block));
+    group.status[0] = reg0a()->raw;
+    group.status[1] = reg0b()->raw;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Computes the fingerprint used to check if a RDS group is equal to the last one of the same group type and segment
+ * @details Most of the RDS stream is the same PS name (0A) and Radio Text (2A) sent again and again. 
+ * @details A 16 bits fingerprint of the blocks B, C and D is kept for each segment of the groups 0A/0B, 2A and 2B and 
+ * @details for the group 4A. A change in a single block (for example, a new pair of chars or a new Text A/B flag) 
+ * @details always changes the fingerprint. Other group types are never considered duplicated.
+ * @param group  raw RDS group
+ * @param fingerprint  returns the fingerprint of the group
+ * @return fingerprint slot (index of bk_rds_data::fingerprint) or BK_RDS_FINGERPRINTS if the group type has no slot
+ */
+uint8_t BK108X::getRdsFingerprint(const bk_rds_group &group, uint16_t &fingerprint)
+{
+    bk_rds_blockb blkB;
+    uint8_t idx;
+
+    blkB.blockB.raw = group.block[1];
+    switch (blkB.refined.groupType)
+    {
+    case 0:
+        idx = blkB.group0.address;
+        break;
+    case 2:
+        idx = ((blkB.refined.versionCode) ? 20 : 4) + blkB.group2.address;
+        break;
+    case 4:
+        if (blkB.refined.versionCode)
+            return BK_RDS_FINGERPRINTS;
+        idx = 36;
+        break;
+    default:
+        return BK_RDS_FINGERPRINTS;
+    }
+
+    uint16_t c = group.block[2], d = group.block[3];
+    fingerprint = group.block[1] ^ (uint16_t)((c << 5) | (c >> 11)) ^ (uint16_t)((d << 11) | (d >> 5));
+    return idx;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Decodes the RDS group stored in bk_rds_data::group
+ * @details The buffers are filled incrementally by the segment address of the groups: 
+ * | Group | Buffer | Segment |
+ * | ----- | ------ | ------- | 
+ * | 0A/0B | buffer0A (Program Service name, 8 chars) | 2 chars from block D |
+ * | 2A    | buffer2A (Radio Text, 64 chars) | 4 chars from blocks C and D |
+ * | 2B    | buffer2B (Radio Text, 32 chars) | 2 chars from block D |
+ * | 4A    | time (Clock Time) | blocks B, C and D |
+ * @details The Radio Text buffers are cleared when the Text A/B flag changes.
+ */
+void BK108X::processRdsGroup()
+{
+    bk_rds_data *rds = rdsBuffers(); // Not NULL: called by processRds
+    bk_rds_blockb blkB;
+    char *segment;
+    char old[4];
+
+    if (rds->group.block[0] != this->rdsPi)
+    {
+        if (rds->group.block[0] == this->rdsPiNext)
+        {
+            this->rdsPi = rds->group.block[0]; // New program: its AF list is collected from scratch
+            this->afCount = 0;
+        }
+        else
+            this->rdsPiNext = rds->group.block[0];
+    }
+
+    blkB.blockB.raw = rds->group.block[1];
+    switch (blkB.refined.groupType)
+    {
+    case 0:
+        if (blkB.refined.versionCode == 0 && rds->group.block[0] == this->rdsPi)
+        {
+            collectAf(rds->group.block[2] >> 8);
+            collectAf(rds->group.block[2] & 0xFF);
+        }
+        segment = &rds->buffer0A[blkB.group0.address * 2];
+        memcpy(old, segment, 2);
+        getNext2Block(segment);
+        if (!(this->rdsReceived & BK_RDS_0A) || memcmp(old, segment, 2) != 0)
+            this->rdsChanged |= BK_CHANGED_RDS_PS;
+        this->rdsReceived |= BK_RDS_0A;
+        break;
+    case 2:
+        if (blkB.refined.versionCode == 0)
+        {
+            if (blkB.group2.textABFlag != this->rdsTextAB2A)
+            {
+                memset(rds->buffer2A, ' ', sizeof(rds->buffer2A) - 1);
+                this->rdsTextAB2A = blkB.group2.textABFlag;
+                this->rdsChanged |= BK_CHANGED_RDS_RT;
+            }
+            segment = &rds->buffer2A[blkB.group2.address * 4];
+            memcpy(old, segment, 4);
+            getNext4Block(segment);
+            if (!(this->rdsReceived & BK_RDS_2A) || memcmp(old, segment, 4) != 0)
+                this->rdsChanged |= BK_CHANGED_RDS_RT;
+            this->rdsReceived |= BK_RDS_2A;
+        }
+        else
+        {
+            if (blkB.group2.textABFlag != this->rdsTextAB2B)
+            {
+                memset(rds->buffer2B, ' ', sizeof(rds->buffer2B) - 1);
+                this->rdsTextAB2B = blkB.group2.textABFlag;
+                this->rdsChanged |= BK_CHANGED_RDS_RT;
+            }
+            segment = &rds->buffer2B[blkB.group2.address * 2];
+            memcpy(old, segment, 2);
+            getNext2Block(segment);
+            if (!(this->rdsReceived & BK_RDS_2B) || memcmp(old, segment, 2) != 0)
+                this->rdsChanged |= BK_CHANGED_RDS_RT;
+            this->rdsReceived |= BK_RDS_2B;
+        }
+        break;
+    case 4:
+        if (blkB.refined.versionCode == 0)
+        {
+            bk_rds_date_time dt;
+            dt.raw[0] = rds->group.block[3];
+            dt.raw[1] = rds->group.block[2];
+            dt.raw[2] = rds->group.block[1];
+
+            uint8_t hour = (dt.refined.hour2 << 4) | dt.refined.hour1;
+            uint8_t minute = dt.refined.minute;
+            uint16_t offset = dt.refined.offset * 30; // minutes 
+            if (hour > 23 || minute > 59)
+                break;
+            char t[13];
+            t[0] = '0' + hour / 10;
+            t[1] = '0' + hour % 10;
+            t[2] = ':';
+            t[3] = '0' + minute / 10;
+            t[4] = '0' + minute % 10;
+            t[5] = ' ';
+            t[6] = (dt.refined.offset_sense) ? '-' : '+';
+            t[7] = '0' + (offset / 60) / 10;
+            t[8] = '0' + (offset / 60) % 10;
+            t[9] = ':';
+            t[10] = '0' + (offset % 60) / 10;
+            t[11] = '0' + (offset % 60) % 10;
+            t[12] = '\0';
+            if (!(this->rdsReceived & BK_RDS_4A) || strcmp(t, rds->time) != 0)
+                this->rdsChanged |= BK_CHANGED_RDS_TIME;
+            memcpy(rds->time, t, sizeof(t));
+            this->rdsReceived |= BK_RDS_4A;
+        }
+        break;
+    }
+}
 
+/**
+ * @ingroup GA04
+ * @brief Clears the RDS buffers
+ * @details Called when the receiver is tuned to another channel. The RDS text functions return NULL until new 
+ * @details RDS groups are received.
+ */
+void BK108X::clearRdsBuffer()
+{
+    bk_rds_data *rds = rdsBuffers();
+    if (rds != NULL)
+    {
+        memset(rds->buffer0A, ' ', sizeof(rds->buffer0A) - 1);
+        memset(rds->buffer2A, ' ', sizeof(rds->buffer2A) - 1);
+        memset(rds->buffer2B, ' ', sizeof(rds->buffer2B) - 1);
+        rds->buffer0A[sizeof(rds->buffer0A) - 1] = '\0';
+        rds->buffer2A[sizeof(rds->buffer2A) - 1] = '\0';
+        rds->buffer2B[sizeof(rds->buffer2B) - 1] = '\0';
+        rds->time[0] = '\0';
+        memset(rds->lastGroup, 0, sizeof(rds->lastGroup));
+        memset(&rds->group, 0, sizeof(rds->group));
+        memset(rds->fingerprint, 0xFF, sizeof(rds->fingerprint));
+    }
+    if (this->rdsReceived & BK_RDS_0A)
+        this->rdsChanged |= BK_CHANGED_RDS_PS;
+    if (this->rdsReceived & (BK_RDS_2A | BK_RDS_2B))
+        this->rdsChanged |= BK_CHANGED_RDS_RT;
+    if (this->rdsReceived & BK_RDS_4A)
+        this->rdsChanged |= BK_CHANGED_RDS_TIME;
+    this->rdsQueue->clear();
+    this->rdsReceived = 0;
+    this->rdsLastTime = 0;
 }
 
 /**
@@ -1073,15 +3037,43 @@ void BK108X::setRdsMode(uint8_t rds_mode)
  * @ingroup GA04
  * @brief Sets the RDS operation 
  * @details Enable or Disable the RDS
+ * @details In the BK108X_SLIM profile, the RDS groups are decoded only if the sketch gave the buffers (see setRdsBuffers).
  * 
  * @param true = turns the RDS ON; false  = turns the RDS OFF
  */
 void BK108X::setRds(bool value)
 {
-    reg04->refined.RDSEN = value;
-    setRegister(REG04,reg04->raw);
+    reg04()->refined.RDSEN = value;
+    setRegister(REG04,reg04()->raw);
+}
+
+#if defined(BK108X_SLIM)
+BK108XRdsRing<1> BK108X::rdsNoQueue;
 
+/**
+ * @ingroup GA04
+ * @brief Gives the RDS buffers (BK108X_SLIM profile only)
+ * @details In the slim profile, the RDS buffers are not a member of BK108X. Without them, the RDS groups are not 
+ * @details decoded and the RDS text functions return NULL. The built-in queue of the buffers is used unless 
+ * @details setRdsQueue gave another one. 
+ * @code
+ * bk_rds_data rdsBuffers; // Global or static: it must exist while the receiver uses it
+ * 
+ * rx.setRdsBuffers(&rdsBuffers);
+ * rx.setRds(true);
+ * @endcode
+ * @param data  buffers declared in your sketch; NULL stops the RDS decoding (the buffers can be used for other things)
+ */
+void BK108X::setRdsBuffers(bk_rds_data *data)
+{
+    if (this->rdsData != NULL && this->rdsQueue == &this->rdsData->queue)
+        this->rdsQueue = &rdsNoQueue;
+    this->rdsData = data;
+    if (data != NULL && this->rdsQueue == &rdsNoQueue)
+        this->rdsQueue = &data->queue;
+    clearRdsBuffer();
 }
+#endif
 
 
 /**
@@ -1090,13 +3082,23 @@ void BK108X::setRds(bool value)
  * @details Read address 0Ah and check the bit RDSR.
  * @details If in verbose mode, the BLERA bits indicate how many errors were corrected in block A. If BLERA indicates 6 or more errors, the data in RDSA should be discarded.
  * @details When using the polling method, it is best not to poll continuously. The data will appear in intervals of ~88 ms and the RDSR indicator will be available for at least 40 ms, so a polling rate of 40 ms or less should be sufficient.
+ * @details If rdsInterruptPin is set, the register is read only after the device signals a new RDS group.
+ * @details When RDSR is 1, the registers 0x0B to 0x0F are read in a single transaction and the queued groups are decoded into the RDS buffers.
  * @return true 
  * @return false 
  */
 bool BK108X::getRdsReady()
 {
+    if (!hasInterrupt(BK_IRQ_RDS, this->rdsInterruptPin))
+        return false;
     getRegister(REG0A);
-    return reg0a->refined.RDSR;
+    if (reg0a()->refined.RDSR)
+    {
+        readRegisters(REG0B, REG0F - REG0B + 1, NULL); // Error bits and blocks A to D in a single transaction
+        queueRdsGroup();
+        processRds();
+    }
+    return reg0a()->refined.RDSR;
 };
 
 /**
@@ -1108,7 +3110,12 @@ bool BK108X::getRdsReady()
  */
 uint8_t BK108X::getRdsFlagAB(void)
 {
-    return 0;
+    bk_rds_data *rds = rdsBuffers();
+    bk_rds_blockb blkB;
+    if (rds == NULL)
+        return 0;
+    blkB.blockB.raw = rds->group.block[1];
+    return blkB.refined.textABFlag;
 }
 
 /**
@@ -1119,7 +3126,12 @@ uint8_t BK108X::getRdsFlagAB(void)
  */
 uint16_t BK108X::getRdsGroupType()
 {
-    return 0;
+    bk_rds_data *rds = rdsBuffers();
+    bk_rds_blockb blkB;
+    if (rds == NULL)
+        return 0;
+    blkB.blockB.raw = rds->group.block[1];
+    return blkB.refined.groupType;
 }
 
 /**
@@ -1130,7 +3142,12 @@ uint16_t BK108X::getRdsGroupType()
  */
 uint8_t BK108X::getRdsVersionCode(void)
 {
-   return 0; 
+    bk_rds_data *rds = rdsBuffers();
+    bk_rds_blockb blkB;
+    if (rds == NULL)
+        return 0;
+    blkB.blockB.raw = rds->group.block[1];
+    return blkB.refined.versionCode;
 }
 
 /**  
@@ -1141,34 +3158,64 @@ uint8_t BK108X::getRdsVersionCode(void)
  */
 uint8_t BK108X::getRdsProgramType(void)
 {
-    return 0;
+    bk_rds_data *rds = rdsBuffers();
+    bk_rds_blockb blkB;
+    if (rds == NULL)
+        return 0;
+    blkB.blockB.raw = rds->group.block[1];
+    return blkB.refined.programType;
 }
 
 /**
- * @todo to be implemented 
  * @ingroup GA04
  * 
- * @brief Process data received from group 2B
- * @param c  char array reference to the "group 2B" text 
+ * @brief Copies the 2 chars of the block D to a RDS buffer
+ * @details Control chars are replaced by spaces. A carriage return (end of the text) terminates the string.
+ * @param c  char array reference to the segment of the buffer
  */
 void BK108X::getNext2Block(char *c)
 {
-    this->rds_buffer2B[0] = *c;
-    c = NULL;
+    bk_rds_data *rds = rdsBuffers();
+    char raw[2];
+
+    raw[0] = rds->group.block[3] >> 8;
+    raw[1] = rds->group.block[3] & 0xFF;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (raw[i] == 0x0D)
+        {
+            c[i] = '\0';
+            return;
+        }
+        c[i] = (raw[i] >= 32) ? raw[i] : ' ';
+    }
 }
 
 /**
- * @todo to be implemented 
  * @ingroup GA04
  * 
- * @brief Process data received from group 2A
- * 
- * @param c  char array reference to the "group  2A" text 
+ * @brief Copies the 4 chars of the blocks C and D to a RDS buffer
+ * @details Control chars are replaced by spaces. A carriage return (end of the text) terminates the string.
+ * @param c  char array reference to the segment of the buffer
  */
 void BK108X::getNext4Block(char *c)
 {
-    this->rds_buffer2A[0] = *c;
-    c = NULL;
+    bk_rds_data *rds = rdsBuffers();
+    char raw[4];
+
+    raw[0] = rds->group.block[2] >> 8;
+    raw[1] = rds->group.block[2] & 0xFF;
+    raw[2] = rds->group.block[3] >> 8;
+    raw[3] = rds->group.block[3] & 0xFF;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        if (raw[i] == 0x0D)
+        {
+            c[i] = '\0';
+            return;
+        }
+        c[i] = (raw[i] >= 32) ? raw[i] : ' ';
+    }
 }
 
 /**
@@ -1179,61 +3226,511 @@ void BK108X::getNext4Block(char *c)
  */
 char *BK108X::getRdsText(void)
 {
-    return NULL;
+    return getRdsText2A();
 }
 
 /**
  * @ingroup GA04
  * @todo RDS Dynamic PS or Scrolling PS support
  * @brief Gets the station name and other messages. 
- * 
- * @return char* should return a string with the station name. 
+ * @details The buffer is updated by getRdsReady, getRdsStatus or processRds.
+ * @return char* should return a string with the station name (NULL if no group 0A/0B was received). 
  *         However, some stations send other kind of messages
  */
 char *BK108X::getRdsText0A(void)
 {
-    return NULL;
+    return (this->rdsReceived & BK_RDS_0A) ? rdsBuffers()->buffer0A : NULL;
 }
 
 /**
  * @ingroup @ingroup GA04
  * 
  * @brief Gets the Text processed for the 2A group
- * 
- * @return char* string with the Text of the group A2  
+ * @details The buffer is updated by getRdsReady, getRdsStatus or processRds.
+ * @return char* string with the Text of the group A2 (NULL if no group 2A was received)
  */
 char *BK108X::getRdsText2A(void)
 {
-    return NULL;
+    return (this->rdsReceived & BK_RDS_2A) ? rdsBuffers()->buffer2A : NULL;
 }
 
 /**
  * @ingroup GA04
  * @brief Gets the Text processed for the 2B group
- * @return char* string with the Text of the group AB  
+ * @details The buffer is updated by getRdsReady, getRdsStatus or processRds.
+ * @return char* string with the Text of the group AB (NULL if no group 2B was received)
  */
 char *BK108X::getRdsText2B(void)
 {
-    return NULL;
+    return (this->rdsReceived & BK_RDS_2B) ? rdsBuffers()->buffer2B : NULL;
 }
 
 /**
  * @ingroup GA04 
  * @brief Gets the RDS time and date when the Group type is 4 
- * @return char* a string with hh:mm +/- offset
+ * @details The buffer is updated by getRdsReady, getRdsStatus or processRds.
+ * @return char* a string with hh:mm +/- offset (UTC time and local time offset; NULL if no group 4A was received)
  */
 char *BK108X::getRdsTime()
 {
-    return NULL;
+    return (this->rdsReceived & BK_RDS_4A) ? rdsBuffers()->time : NULL;
 }
 
 /**
  * @ingroup GA04 
  * @brief Get the Rds Sync 
  * @details Returns true if RDS currently synchronized.
+ * @details The BK108X does not report the RDS synchronization status. So, the receiver is considered synchronized 
+ * @details if a RDS group was received in the last BK_RDS_SYNC_TIMEOUT ms.
  * @return true or false
  */
 bool BK108X::getRdsSync()
 {
-    return NULL;
+    return this->rdsLastTime != 0 && (millis() - this->rdsLastTime) < BK_RDS_SYNC_TIMEOUT;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Adds an AF code of a 0A group to the list of the current program
+ * @details Only the codes of FM frequencies (1 to 204) inside the current band and space are kept. The filler, 
+ * @details count and LF/MF codes are ignored.
+ * @param code  AF code (frequency = 87.5MHz + code x 100kHz)
+ */
+void BK108X::collectAf(uint8_t code)
+{
+    if (code == 0 || code > 204 || this->afCount == BK_AF_MAX)
+        return;
+    uint16_t frequency = 8750 + code * 10;
+    if (frequency < this->bandStart || frequency > this->bandEnd || frequency == this->currentFrequency ||
+        channelToFrequency(frequencyToChannel(frequency)) != frequency)
+        return;
+    for (uint8_t i = 0; i < this->afCount; i++)
+        if (this->afList[i] == code)
+            return;
+    this->afList[this->afCount++] = code;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Stops the AF following round in progress and forgets the program
+ * @details Called when the receiver is tuned by other functions (tune, seek, scan). The audio muted by the round
+ * @details is restored. The PI and the AF list are collected again from the new channel.
+ */
+void BK108X::abortAf()
+{
+    if (this->afMuted)
+        setAudioMute(false);
+    this->afMuted = false;
+    this->afState = AF_MONITOR;
+    this->afLowCount = 0;
+    this->afCount = 0;
+    this->rdsPi = this->rdsPiNext = 0;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Checks if the AF following is out of the program channel (probe or PI check)
+ * @details The RDS and status tick tasks do not run in this case.
+ */
+bool BK108X::isAfChecking()
+{
+    return this->afState >= AF_PROBE;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Mutes the audio (if not muted yet) and tunes a channel in a single transaction (registers 0x02 and 0x03)
+ * @details Does not change the current channel and frequency, the tune state or the RDS buffers.
+ */
+void BK108X::startAfTune(uint16_t channel)
+{
+    if (reg03()->refined.TUNE)
+    {
+        reg03()->refined.TUNE = 0;
+        setRegister(REG03, reg03()->raw);
+    }
+    if (!reg02()->refined.MUTEL && !reg02()->refined.MUTER)
+    {
+        reg02()->refined.MUTEL = reg02()->refined.MUTER = 1;
+        this->afMuted = true;
+    }
+    reg03()->refined.TUNE = 1;
+    reg03()->refined.CHAN = channel;
+    writeRegisters(REG02, 2, &shadowRegisters[REG02]);
+
+    reg0a()->refined.STC = 0;
+    this->afTime = millis();
+    uint8_t latency = getTuneLatency();
+    startStcPolling(BK_STC_POLL_MAX, latency - latency / 8);
+}
+
+/**
+ * @ingroup GA04
+ * @brief Checks if the tune started by startAfTune completed
+ * @details Reads SNR (0x09) and the status (0x0A) in a single transaction. reg0a()->refined.STC tells if the tune 
+ * @details completed or if BK_AF_PROBE_TIMEOUT expired.
+ * @return true if STC was set or the timeout expired
+ */
+bool BK108X::isAfTuneDone()
+{
+    bool timeout = (millis() - this->afTime) > BK_AF_PROBE_TIMEOUT;
+    if (!timeout && !isStcPollDue())
+        return false;
+    if (!readRegisters(REG09, 2, NULL))
+        reg0a()->refined.STC = 0;
+    return reg0a()->refined.STC || timeout;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Clears TUNE after an AF tune and, optionally, restores the audio in the same transaction
+ */
+void BK108X::endAfTune(bool unmute)
+{
+    reg03()->refined.TUNE = 0;
+    if (unmute && this->afMuted)
+    {
+        reg02()->refined.MUTEL = reg02()->refined.MUTER = 0;
+        this->afMuted = false;
+        writeRegisters(REG02, 2, &shadowRegisters[REG02]);
+    }
+    else
+        setRegister(REG03, reg03()->raw);
+}
+
+/**
+ * @ingroup GA04
+ * @brief Starts the probe of the next AF of the round
+ */
+uint8_t BK108X::startAfProbe()
+{
+    startAfTune(frequencyToChannel(getAfFrequency(this->afIndex)));
+    this->afState = AF_PROBE;
+    return BK_AF_CHECKING;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Rejects the AF being checked and goes back (muted) to the program channel
+ * @details The next best AF is checked after BK_AF_PROBE_GAP ms.
+ */
+uint8_t BK108X::rejectAf()
+{
+    this->afLevel[this->afBest] = 0;
+    startAfTune(this->afHomeChannel);
+    this->afState = AF_RETURN;
+    return BK_AF_CHECKING;
+}
+
+/**
+ * @ingroup GA04
+ * @brief Runs the RDS alternative frequency (AF) following
+ * @details Call it often (about every ms during a round) or let tick run it (BK_TASK_AF). See setAf.
+ * @details 1) Monitor: when BK_AF_LOW_COUNT consecutive status snapshots (see update) are below the AF threshold, 
+ * @details    a round starts (at most one round every BK_AF_HOLD ms if no AF is used).
+ * @details 2) Probes: each AF is measured (RSSI and SNR at STC) with the audio muted and the receiver goes back to 
+ * @details    the program channel. The audio returns between two probes for BK_AF_PROBE_GAP ms.
+ * @details 3) PI check: the best AF with RSSI above the program channel by the margin (see setAfThreshold) and SNR 
+ * @details    above the threshold is tuned. The audio returns at STC and the AF is used as soon as a RDS group with 
+ * @details    the PI of the program is received. Otherwise, after BK_AF_PI_TIMEOUT ms, the receiver goes back to the 
+ * @details    program channel and the next best one is checked.
+ * @details The audio is muted only during the tunes: a probe mutes it for two tunes (the AF and back to the program
+ * @details channel) and a PI check for one tune on the way in and, if the PI is not received, one on the way back.
+ * @details Each tune is bounded by BK_AF_PROBE_TIMEOUT: the worst case is 2 x BK_AF_PROBE_TIMEOUT ms (a probe) plus
+ * @details the bus time.
+ * @details When an AF is used, the previous channel takes its place in the AF list. The RDS buffers are kept (same
+ * @details program).
+ * @return BK_AF_SWITCHED once, when an AF is used; BK_AF_CHECKING during a round; BK_AF_IDLE otherwise.
+ */
+uint8_t BK108X::pollAf()
+{
+    uint32_t now = millis();
+
+    switch (this->afState)
+    {
+    case AF_MONITOR:
+        if (!this->afEnabled || !this->signalQualityValid || this->signalQuality.timestamp == this->afLastSample)
+            return BK_AF_IDLE;
+        this->afLastSample = this->signalQuality.timestamp;
+        if (this->afCount == 0 || isTuning() || isSeeking() || isScanning() ||
+            (this->signalQuality.rssi >= this->afRssi && this->signalQuality.snr >= this->afSnr))
+        {
+            this->afLowCount = 0;
+            return BK_AF_IDLE;
+        }
+        if (++this->afLowCount < BK_AF_LOW_COUNT || (int32_t)(now - this->afTime) < 0)
+            return BK_AF_IDLE;
+        this->afLowCount = 0;
+        this->afHomeChannel = this->currentChannel;
+        this->afHomeLevel = this->signalQuality.rssi;
+        this->afIndex = 0;
+        return startAfProbe();
+
+    case AF_GAP:
+        if ((int32_t)(now - this->afTime) < 0)
+            return BK_AF_CHECKING;
+        if (this->afIndex < this->afCount)
+            return startAfProbe();
+
+        this->afBest = BK_AF_MAX;
+        for (uint8_t i = 0; i < this->afCount; i++)
+            if (this->afLevel[i] != 0 && this->afLevel[i] >= this->afHomeLevel + this->afMargin &&
+                (this->afBest == BK_AF_MAX || this->afLevel[i] > this->afLevel[this->afBest]))
+                this->afBest = i;
+        if (this->afBest == BK_AF_MAX)
+        {
+            this->afState = AF_MONITOR;
+            this->afTime = now + BK_AF_HOLD;
+            return BK_AF_IDLE;
+        }
+        startAfTune(frequencyToChannel(getAfFrequency(this->afBest)));
+        this->afState = AF_SWITCH;
+        return BK_AF_CHECKING;
+
+    case AF_PROBE:
+        if (!isAfTuneDone())
+            return BK_AF_CHECKING;
+        this->afLevel[this->afIndex] = (reg0a()->refined.STC && reg09()->refined.SNR >= this->afSnr) ? reg0a()->refined.RSSI : 0;
+        this->afIndex++;
+        endAfTune(false);
+        startAfTune(this->afHomeChannel);
+        this->afState = AF_RETURN;
+        return BK_AF_CHECKING;
+
+    case AF_RETURN:
+        if (!isAfTuneDone())
+            return BK_AF_CHECKING;
+        endAfTune(true);
+        this->signalQualityValid = false;
+        this->afTime = now + BK_AF_PROBE_GAP;
+        this->afState = AF_GAP;
+        return BK_AF_CHECKING;
+
+    case AF_SWITCH:
+        if (!isAfTuneDone())
+            return BK_AF_CHECKING;
+        if (!reg0a()->refined.STC)
+            return rejectAf();
+        endAfTune(true); // The PI is checked with audio
+        this->afTime = now;
+        this->afReadTime = (uint8_t)now - BK_AF_PI_POLL;
+        this->afState = AF_VERIFY;
+        return BK_AF_CHECKING;
+
+    case AF_VERIFY:
+    {
+        if ((now - this->afTime) > BK_AF_PI_TIMEOUT)
+            return rejectAf(); // No group with the PI of the program
+        if (this->rdsInterruptPin >= 0)
+        {
+            if (!hasInterrupt(BK_IRQ_RDS, this->rdsInterruptPin))
+                return BK_AF_CHECKING;
+        }
+        else if ((uint8_t)((uint8_t)now - this->afReadTime) < BK_AF_PI_POLL)
+            return BK_AF_CHECKING;
+        this->afReadTime = (uint8_t)now;
+        readRegisters(REG0A, REG0F - REG0A + 1, NULL); // Status and blocks A to D in a single transaction
+        if (!reg0a()->refined.RDSR || reg0c()->raw != this->rdsPi)
+            return BK_AF_CHECKING;
+
+        uint16_t channel = frequencyToChannel(getAfFrequency(this->afBest));
+        uint16_t home = channelToFrequency(this->afHomeChannel);
+        if (home > 8750 && home <= 8750 + 204 * 10 && (home - 8750) % 10 == 0)
+            this->afList[this->afBest] = (home - 8750) / 10; // The previous channel is now an AF of the program
+        else
+            this->afList[this->afBest] = this->afList[--this->afCount];
+        this->currentChannel = channel;
+        this->currentFrequency = channelToFrequency(channel);
+        this->signalQualityValid = false;
+        this->afState = AF_MONITOR;
+        this->afTime = now;
+        return BK_AF_SWITCHED;
+    }
+    }
+    return BK_AF_IDLE;
+}
+
+/**
+ * @defgroup GA07 Background Tasks
+ * @section GA07 tick
+ */
+
+/**
+ * @ingroup GA07
+ * @brief Checks if a tick task has work to do
+ * @details The tune task does not run during a scan (the scan completes its own tunes) and the RDS and status 
+ * @details tasks only run when the receiver is not tuning, seeking or checking an alternative frequency.
+ * @details In the low power mode (see setLowPower), they also need a subscriber. No task runs in standby.
+ */
+bool BK108X::isTaskActive(uint8_t task)
+{
+    if (this->standbyMode)
+        return false;
+    switch (task)
+    {
+    case BK_TASK_TUNE:
+        return isTuning() && !isScanning();
+    case BK_TASK_SEEK:
+        return isSeeking();
+    case BK_TASK_SCAN:
+        return isScanning();
+    case BK_TASK_RDS:
+        if (this->lowPower && !(this->subscriptions & (BK_CHANGED_RDS_PS | BK_CHANGED_RDS_RT | BK_CHANGED_RDS_TIME)))
+            return false;
+        return reg04()->refined.RDSEN && !isTuning() && !isSeeking() && !isAfChecking();
+    case BK_TASK_STATUS:
+        if (this->lowPower && !this->subscriptions)
+            return false;
+        return !isTuning() && !isSeeking() && !isScanning() && !isAfChecking();
+    case BK_TASK_USER:
+        return this->userTask != NULL;
+    case BK_TASK_AF:
+        // Nothing to do while monitoring until the status task refreshes the snapshot
+        return this->afEnabled && (this->afState != AF_MONITOR || this->signalQuality.timestamp != this->afLastSample);
+    }
+    return false;
+}
+
+/**
+ * @ingroup GA07
+ * @brief Runs a tick task
+ */
+void BK108X::runTask(uint8_t task)
+{
+    switch (task)
+    {
+    case BK_TASK_TUNE:
+        pollTune();
+        break;
+    case BK_TASK_SEEK:
+        pollSeek();
+        break;
+    case BK_TASK_SCAN:
+        pollScan();
+        break;
+    case BK_TASK_RDS:
+        captureRds();
+        processRds(1);
+        break;
+    case BK_TASK_STATUS:
+        update();
+        break;
+    case BK_TASK_USER:
+        this->userTask();
+        break;
+    case BK_TASK_AF:
+        pollAf();
+        break;
+    }
+}
+
+/**
+ * @ingroup GA07
+ * @brief Runs the background work of the receiver
+ * @details Single entry point for the non-blocking operation of the receiver: tune completion, seek progress, scan
+ * @details steps, RDS capture and decoding, signal quality / stereo monitor (update), RDS alternative frequency
+ * @details following (see setAf) and a user task (for example, the preset persistence of BK108XStorage). Each task has a slot with a period and a time budget.
+ * @details A call runs the due tasks (period elapsed and work to do) in deadline order (the most late first), each 
+ * @details task at most once, while the next one fits in budget_us. The most urgent task always runs. So, a call 
+ * @details takes at most about budget_us plus the budget of one task, and no call waits for the device.
+ * @details Start the operations with the non-blocking functions (startTune, startSeek, startScan) and get the 
+ * @details results from the callbacks (setTuneCallback, setSeekCallback, setUpdateCallback) instead of the 
+ * @details blocking ones (setFrequency, seekHardware, scanBand), which wait with delay().
+ * @code
+ * void setup() {
+ *   rx.setup(SDIO_PIN, SCLK_PIN);
+ *   rx.setFM(8400, 10800, 10390, 10);
+ *   rx.setRds(true);
+ *   rx.setUpdateCallback(showStatus);   // Frequency, RSSI, stereo and RDS changes
+ * }
+ *
+ * void loop() {
+ *   if (digitalRead(SEEK_BUTTON) == LOW)
+ *      rx.startSeek(BK_SEEK_WRAP, BK_SEEK_UP);
+ *   rx.tick(millis());
+ *   // Other tasks
+ * }
+ * @endcode
+ * @see setTaskPeriod, setTaskBudget, setUserTask
+ * @param now_ms     current time (millis())
+ * @param budget_us  time budget of this call in microseconds (default BK_TICK_BUDGET)
+ * @return bit mask of the tasks run (1 << BK_TASK_TUNE, 1 << BK_TASK_SEEK...); 0 = nothing to do
+ */
+uint8_t BK108X::tick(uint32_t now_ms, uint16_t budget_us)
+{
+    uint32_t start = micros();
+    uint8_t done = 0;
+
+    for (;;)
+    {
+        uint8_t task = BK_TASKS;
+        uint32_t late = 0;
+
+        for (uint8_t i = 0; i < BK_TASKS; i++)
+        {
+            uint16_t period = getTaskPeriod(i);
+            uint32_t elapsed = now_ms - this->tasks[i].last;
+            if ((done & (1 << i)) || period == 0 || elapsed < period || !isTaskActive(i))
+                continue;
+            if (task == BK_TASKS || elapsed - period > late)
+            {
+                task = i;
+                late = elapsed - period;
+            }
+        }
+        if (task == BK_TASKS)
+            break;
+        if (done && (micros() - start) + this->tasks[task].budget > budget_us)
+            break;
+
+        this->tasks[task].last = now_ms;
+        runTask(task);
+        done |= 1 << task;
+    }
+    return done;
+}
+
+/**
+ * @ingroup GA07
+ * @brief Gets the period of a tick task in the current power mode
+ * @details In the low power mode (see setLowPower), the status task runs every low power period and, with 
+ * @details rdsInterruptPin set, the RDS task waits for the GPIO2 pulse (or the low power fallback read).
+ */
+uint16_t BK108X::getTaskPeriod(uint8_t task)
+{
+    uint16_t period = this->tasks[task].period;
+    if (!this->lowPower || period == 0)
+        return period;
+    if (task == BK_TASK_STATUS)
+        return this->lowPowerPeriod;
+    if (task == BK_TASK_RDS && this->rdsInterruptPin >= 0 && !(interruptFlags & BK_IRQ_RDS))
+        return this->lowPowerPeriod;
+    return period;
+}
+
+/**
+ * @ingroup GA07
+ * @brief Gets how long tick has nothing to do
+ * @details The MCU can sleep for this time (or until an interrupt) between two tick calls. A tune, seek or scan in 
+ * @details progress keeps it short (1ms by default).
+ * @see tick, setLowPower
+ * @param now_ms current time (millis())
+ * @return time in ms until the next task is due (0 = call tick now); BK_IDLE_FOREVER if no task has work to do
+ */
+uint32_t BK108X::getIdleTime(uint32_t now_ms)
+{
+    uint32_t idle = BK_IDLE_FOREVER;
+
+    for (uint8_t i = 0; i < BK_TASKS; i++)
+    {
+        uint16_t period = getTaskPeriod(i);
+        if (period == 0 || !isTaskActive(i))
+            continue;
+        uint32_t elapsed = now_ms - this->tasks[i].last;
+        if (elapsed >= period)
+            return 0;
+        if (period - elapsed < idle)
+            idle = period - elapsed;
+    }
+    return idle;
 }
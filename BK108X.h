@@ -16,6 +16,9 @@
  * Contact: pu2clr@gmail.com
  */
 
+#ifndef _BK108X_H // Prevent this file from being compiled more than once
+#define _BK108X_H
+
 #include <Arduino.h>
 
 #define MAX_DELAY_AFTER_OSCILLATOR 500 // Max delay after the crystal oscilator becomes active
@@ -23,6 +26,7 @@
 #define I2C_DEVICE_ADDR 0x80
 
 #define MAX_SEEK_TIME 3000 // Maximum time have to be a seeking process (in ms).
+#define MAX_TUNE_TIME 500  // Maximum time to wait for STC after starting a tune (in ms).
 
 #define OSCILLATOR_TYPE_CRYSTAL 1 // Crystal
 #define OSCILLATOR_TYPE_REFCLK 0  // Reference clock
@@ -50,6 +54,126 @@
 #define DE_EMPHASIS_75 0
 #define DE_EMPHASIS_50 1
 
+#define BK_IRQ_STC 1 //!< Interrupt flag: Seek/Tune complete signaled on GPIO2
+#define BK_IRQ_RDS 2 //!< Interrupt flag: new RDS group signaled on GPIO2
+#define BK_IRQ_FALLBACK_POLL 100 //!< Even with interrupts, reads the status register at least every 100ms (in case of a lost pulse)
+#define BK_IRQ_SLOTS 2 //!< Receivers that can use interrupt pins at the same time (one set of ISRs per slot, see setupInterrupts)
+
+#define BK_SEEK_IDLE 0        //!< No seek in progress
+#define BK_SEEK_IN_PROGRESS 1 //!< The device is seeking
+#define BK_SEEK_FOUND 2       //!< Seek completed on a valid station
+#define BK_SEEK_FAIL 3        //!< Seek failed or band limit reached (SF_BL)
+#define BK_SEEK_TIMEOUT 4     //!< Seek aborted after the seek timeout (see setSeekTimeout)
+#define BK_SEEK_ERROR 5       //!< Seek aborted by a bus error (see getBusErrors)
+
+#define BK_RDS_0A 1 //!< RDS buffer flag: Program Service name (groups 0A/0B) received
+#define BK_RDS_2A 2 //!< RDS buffer flag: Radio Text (group 2A) received
+#define BK_RDS_2B 4 //!< RDS buffer flag: Radio Text (group 2B) received
+#define BK_RDS_4A 8 //!< RDS buffer flag: Clock Time (group 4A) received
+#define BK_STATE_MAGIC 0xB108 //!< Identifies a bk_state image (see saveState and restoreState)
+
+#define BK_STATUS_MAX_AGE 10 //!< Default max age (ms) of the status snapshot used by getRssi, getSnr and isStereo (see setStatusMaxAge)
+
+#define BK_CHANGED_FREQUENCY 1  //!< update() change flag: the frequency (tune, seek or scan)
+#define BK_CHANGED_RSSI 2       //!< update() change flag: the RSSI moved to another bucket (see setUpdateResolution)
+#define BK_CHANGED_SNR 4        //!< update() change flag: the SNR moved to another bucket (see setUpdateResolution)
+#define BK_CHANGED_STEREO 8     //!< update() change flag: stereo / mono indicator
+#define BK_CHANGED_RDS_PS 16    //!< update() change flag: RDS Program Service name (getRdsText0A)
+#define BK_CHANGED_RDS_RT 32    //!< update() change flag: RDS Radio Text (getRdsText2A / getRdsText2B)
+#define BK_CHANGED_RDS_TIME 64  //!< update() change flag: RDS Clock Time (getRdsTime)
+
+#define BK_RDS_FINGERPRINTS 37 //!< Fingerprint slots: 0A/0B (4 segments), 2A (16), 2B (16) and 4A (1)
+#define BK_RDS_SYNC_TIMEOUT 500 //!< getRdsSync returns false if no RDS group is received in this time (in ms) 
+
+#ifndef BK108X_RDS_QUEUE_DEPTH
+#define BK108X_RDS_QUEUE_DEPTH 4 //!< Depth of the built-in RDS group queue (power of 2). See BK108XRdsRing and setRdsQueue for a deeper queue.
+#endif
+
+#ifndef BK_SCAN_MAX_STATIONS
+#define BK_SCAN_MAX_STATIONS 24 //!< Size of the scanBand station table (4 bytes per station). Define it before including BK108X.h to change it.
+#endif
+
+#define BK_SCAN_IDLE 0        //!< No scan in progress
+#define BK_SCAN_IN_PROGRESS 1 //!< Walking the band
+#define BK_SCAN_DONE 2        //!< The scan has just completed
+
+#define BK_TUNE_IDLE 0        //!< No tune in progress
+#define BK_TUNE_IN_PROGRESS 1 //!< Waiting for STC (Seek/Tune Complete)
+#define BK_TUNE_DONE 2        //!< The tune has just completed
+#define BK_TUNE_TIMEOUT 3     //!< Tune aborted: no STC within the tune timeout (see setTuneTimeout)
+#define BK_TUNE_ERROR 4       //!< Tune aborted by a bus error (see getBusErrors)
+
+#define BK_STC_POLL_MIN 1       //!< First interval (ms) of the adaptive STC polling. It doubles after each read.
+#define BK_STC_POLL_MAX 8       //!< Maximum STC polling interval (ms) of a tune or scan step
+#define BK_STC_POLL_SEEK_MAX 16 //!< Maximum STC polling interval (ms) of a seek
+
+#define BK_SEEK_CHECK_SAMPLES 3   //!< Default number of signal samples taken at each seek stop (see setSeekValidation)
+#define BK_SEEK_CHECK_INTERVAL 10 //!< Default interval (ms) between two samples of the seek validation
+#define BK_SEEK_CHECK_RSSI 20     //!< Default minimum average RSSI (dBuV) of a valid seek stop
+#define BK_SEEK_CHECK_SNR 8       //!< Default minimum average SNR (dB) of a valid seek stop
+
+#define BK_AF_MAX 8             //!< Maximum alternative frequencies kept for the current program (see setAf)
+#define BK_AF_RSSI 25           //!< Default RSSI (dBuV) below which the alternative frequencies are checked
+#define BK_AF_SNR 10            //!< Default SNR (dB) below which the alternative frequencies are checked
+#define BK_AF_MARGIN 6          //!< Default RSSI gain (dB) an alternative frequency needs to be used
+#define BK_AF_LOW_COUNT 3       //!< Consecutive weak status snapshots (see update) that start a check round
+#define BK_AF_PROBE_GAP 300     //!< Time (ms) with audio between two probes of a round
+#define BK_AF_HOLD 10000        //!< Time (ms) without check rounds after a round that did not switch
+#define BK_AF_PROBE_TIMEOUT 60  //!< Maximum time (ms) to wait for STC on an AF tune (the audio is muted during the tune)
+#define BK_AF_PI_TIMEOUT 250    //!< Maximum time (ms), with audio, to receive the PI of an alternative frequency before using it
+#define BK_AF_PI_POLL 20        //!< Status read interval (ms) while waiting for the PI without rdsInterruptPin (RDSR keeps high for 40ms)
+
+#define BK_AF_IDLE 0     //!< pollAf: monitoring the signal quality
+#define BK_AF_CHECKING 1 //!< pollAf: a check round is in progress
+#define BK_AF_SWITCHED 2 //!< pollAf: the receiver has just moved to an alternative frequency
+
+#define BK_BURST_REGISTERS 16 //!< Maximum registers per bus transaction (the burst buffer is on the stack)
+
+#define BK_BUS_RETRIES 2      //!< Default number of retries of a transaction not acknowledged (see setBusRetry)
+#define BK_BUS_BACKOFF 50     //!< Default wait (us) before the first retry. It doubles at each retry.
+
+#define BK_TASK_TUNE 0    //!< tick task: completes the tune started by startTune (pollTune)
+#define BK_TASK_SEEK 1    //!< tick task: follows the seek started by startSeek (pollSeek)
+#define BK_TASK_SCAN 2    //!< tick task: one step of the scan started by startScan (pollScan)
+#define BK_TASK_RDS 3     //!< tick task: captures and decodes the RDS groups (captureRds and processRds)
+#define BK_TASK_STATUS 4  //!< tick task: refreshes the signal quality, stereo and RDS snapshot (update)
+#define BK_TASK_USER 5    //!< tick task: function set by setUserTask (for example, BK108XStorage::loop)
+#define BK_TASK_AF 6      //!< tick task: RDS alternative frequency following (pollAf, see setAf)
+#define BK_TASKS 7        //!< Number of tick task slots
+#define BK_TICK_BUDGET 2000 //!< Default time budget (us) of a tick call
+#define BK_LOW_POWER_PERIOD 2000 //!< Default status period (ms) of the low power mode (see setLowPower)
+#define BK_IDLE_FOREVER 0xFFFFFFFF //!< getIdleTime: no task will be due; only an interrupt (or a new operation) brings work
+
+#define REGISTER_SETTLE_TIME 250 //!< Default settle time (in us) after writing the power (0x02) and tune (0x03) registers
+
+#define I2C_DEFAULT_HALF_PERIOD 1 //!< Default I2C half clock period in microseconds (the original fixed 1us delay)
+
+/**
+ * @brief Direct port I/O for the bit-banged I2C bus
+ * @details On AVR, ESP32, RP2040 and STM32 (MODER based families) the SDIO and SCLK pins are resolved to
+ * @details port/mask pairs by i2cInit and toggled directly. Define BK108X_DISABLE_FAST_IO before including
+ * @details this file to force the portable digitalWrite/digitalRead implementation.
+ */
+#if !defined(BK108X_DISABLE_FAST_IO)
+#if defined(__AVR__)
+#define BK108X_FAST_IO
+#elif defined(ARDUINO_ARCH_ESP32)
+#define BK108X_FAST_IO
+#elif defined(ARDUINO_ARCH_RP2040)
+#define BK108X_FAST_IO
+#elif defined(ARDUINO_ARCH_STM32) && (defined(GPIO_MODER_MODER0) || defined(GPIO_MODER_MODE0))
+#define BK108X_FAST_IO
+#endif
+#endif
+
+/**
+ * @brief Instrumentation
+ * @details Build with BK108X_STATS defined (compiler flag, e.g. -DBK108X_STATS, so the library and the sketch see 
+ * @details the same class) to count the register reads and writes, the time spent in the bus and in delays, the 
+ * @details tune/seek latencies and the poll calls (see getStats). Without it, nothing is counted.
+ */
+#define BK_STATS_BUCKETS 13 //!< Latency histogram buckets: 0ms, 1ms, 2-3ms, 4-7ms ... 1024-2047ms and >= 2048ms
+
 
 #define REG00 0x00
 #define REG01 0x01
@@ -177,16 +301,16 @@ typedef union
 {
     struct
     {
-        uint8_t DUMMY : 2;   //!< Not used / RESERVED General Purpose I/O 1; 00 = High impedance (default); 01 = CLK38MHz; 10 = Low; 11 = High.
-        uint8_t GPIO2 : 2;   //!< General Purpose I/O 2. 00 = High impedance (default); 01 = STC/RDS interrupt; 10 = Low; 11 = High.
-        uint8_t GPIO3 : 2;   //!< General Purpose I/O 2. 00 = High impedance (default); 01 = Mono/Stereo indicator (ST); 10 = Low; 11 = High.
-        uint8_t PILOTS : 3;   //!< Stereo/Mono Blend Level Adjustment. Sets the RSSI range for stereo/mono blend. See table above.
-        uint8_t TCPILOT : 2; //!< The Time Used to Cal The Strength of Pilot
-        uint8_t DE : 1;      //!< De-emphasis; 0 = 75 μs. Used in USA (default); 1 = 50 μs. Used in Europe, Australia, Japan.
-        uint8_t RDSEN : 1;   //!< RDS Enable; 0 = Disable (default); 1 = Enable.
-        uint8_t AFCINV : 1;  //!< AFC Invert; 0 = Normal AFC into mixer; 1 = Reverse AFC into mixer.
-        uint8_t STCIEN : 1;  //!< Seek/Tune Complete Interrupt Enable; 0 = Disable Interrupt (default); 1 = Enable Interrupt. See details above.
-        uint8_t RDSIEN : 1;  //!< RDS Interrupt Enable; 0 = Disable Interrupt (default); 1 = Enable Interrupt. See details above.
+        uint16_t DUMMY : 2;   //!< Not used / RESERVED General Purpose I/O 1; 00 = High impedance (default); 01 = CLK38MHz; 10 = Low; 11 = High.
+        uint16_t GPIO2 : 2;   //!< General Purpose I/O 2. 00 = High impedance (default); 01 = STC/RDS interrupt; 10 = Low; 11 = High.
+        uint16_t GPIO3 : 2;   //!< General Purpose I/O 2. 00 = High impedance (default); 01 = Mono/Stereo indicator (ST); 10 = Low; 11 = High.
+        uint16_t PILOTS : 3;   //!< Stereo/Mono Blend Level Adjustment. Sets the RSSI range for stereo/mono blend. See table above.
+        uint16_t TCPILOT : 2; //!< The Time Used to Cal The Strength of Pilot
+        uint16_t DE : 1;      //!< De-emphasis; 0 = 75 μs. Used in USA (default); 1 = 50 μs. Used in Europe, Australia, Japan.
+        uint16_t RDSEN : 1;   //!< RDS Enable; 0 = Disable (default); 1 = Enable.
+        uint16_t AFCINV : 1;  //!< AFC Invert; 0 = Normal AFC into mixer; 1 = Reverse AFC into mixer.
+        uint16_t STCIEN : 1;  //!< Seek/Tune Complete Interrupt Enable; 0 = Disable Interrupt (default); 1 = Enable Interrupt. See details above.
+        uint16_t RDSIEN : 1;  //!< RDS Interrupt Enable; 0 = Disable Interrupt (default); 1 = Enable Interrupt. See details above.
     } refined;
     uint16_t raw;
 } bk_reg04;
@@ -219,10 +343,10 @@ typedef union
 {
     struct
     {
-        uint8_t VOLUME : 5; //!< 0x00 is the lowest and 0x1F is highest (0dBFS). 2dB each
-        uint8_t SPACE : 2;  //!< Channel Spacing; See AM and FM Channel Space table above.
-        uint8_t BAND : 2;   //!< Band Select. See AM and Fm Band table above.
-        uint8_t SEEKTH : 7; //!< RSSI Seek Threshold. 0x00 = min RSSI (default); 0x7F = max RSSI.
+        uint16_t VOLUME : 5; //!< 0x00 is the lowest and 0x1F is highest (0dBFS). 2dB each
+        uint16_t SPACE : 2;  //!< Channel Spacing; See AM and FM Channel Space table above.
+        uint16_t BAND : 2;   //!< Band Select. See AM and Fm Band table above.
+        uint16_t SEEKTH : 7; //!< RSSI Seek Threshold. 0x00 = min RSSI (default); 0x7F = max RSSI.
     } refined;
     uint16_t raw;
 } bk_reg05;
@@ -256,11 +380,11 @@ typedef union
 {
     struct
     {
-        uint8_t SKCNT : 4;  //!< See details above.
-        uint8_t SKSNR : 7;  //!< Seek SNR Threshold. Required channel SNR for a valid seek channel
-        uint8_t CLKSEL : 1; //!< Clock Select. 0 = External clock input; 1= Internal oscillator input.
-        uint8_t SMUTEA : 2; //!< Softmute Attenuation; See table above.
-        uint8_t SMUTER : 2; //!< Softmute Attack/Recover Rate; See table above
+        uint16_t SKCNT : 4;  //!< See details above.
+        uint16_t SKSNR : 7;  //!< Seek SNR Threshold. Required channel SNR for a valid seek channel
+        uint16_t CLKSEL : 1; //!< Clock Select. 0 = External clock input; 1= Internal oscillator input.
+        uint16_t SMUTEA : 2; //!< Softmute Attenuation; See table above.
+        uint16_t SMUTER : 2; //!< Softmute Attack/Recover Rate; See table above
     } refined;
     uint16_t raw;
 } bk_reg06;
@@ -299,13 +423,13 @@ typedef union
 {
     struct
     {
-        uint8_t AFCRSSIT : 7; //!< RSSI Threshold for Instant AFC updating
-        uint8_t RANGE : 2;    //!< AFC Average Range; 00 = the toughest; 11 = the loosest
-        uint8_t VAR : 2;      //!< Variation Threshold for average AFC calculation; 00 = Disable; 01 = the toughest; 11 = the loosest
-        uint8_t AVE : 1;      //!< AFC Average
-        uint8_t SEL25K : 1;   //!< AFCRL Threshold; 0 = Channel space/2; 1 = 25kHz
-        uint8_t TCSEL : 2;    //!< AFC/RSSI/SNR Calculate Rate; 00 = fastest; 11 = slowest. 4X times each
-        uint8_t AFCEN : 1;    //!< AFC Enable; 0 = Disable; 1 = Enable.
+        uint16_t AFCRSSIT : 7; //!< RSSI Threshold for Instant AFC updating
+        uint16_t RANGE : 2;    //!< AFC Average Range; 00 = the toughest; 11 = the loosest
+        uint16_t VAR : 2;      //!< Variation Threshold for average AFC calculation; 00 = Disable; 01 = the toughest; 11 = the loosest
+        uint16_t AVE : 1;      //!< AFC Average
+        uint16_t SEL25K : 1;   //!< AFCRL Threshold; 0 = Channel space/2; 1 = 25kHz
+        uint16_t TCSEL : 2;    //!< AFC/RSSI/SNR Calculate Rate; 00 = fastest; 11 = slowest. 4X times each
+        uint16_t AFCEN : 1;    //!< AFC Enable; 0 = Disable; 1 = Enable.
     } refined;
     uint16_t raw;
 } bk_reg08;
@@ -482,10 +606,10 @@ typedef union
 {
     struct
     {
-        uint8_t RSSIMTH : 7; //!< The Mute Threshold Based on RSSI
-        uint8_t SNRMTH : 7;  //!< The Mute Threshold Based on SNR
-        uint8_t AFCMUTE : 1; //!< 0: disable soft mute when AFCRL is high; 1: enable soft mute when AFCRL is high
-        uint8_t SKMUTE : 1;  //!< 0: disable soft mute when seeking; 1: enable soft mute when seeking
+        uint16_t RSSIMTH : 7; //!< The Mute Threshold Based on RSSI
+        uint16_t SNRMTH : 7;  //!< The Mute Threshold Based on SNR
+        uint16_t AFCMUTE : 1; //!< 0: disable soft mute when AFCRL is high; 1: enable soft mute when AFCRL is high
+        uint16_t SKMUTE : 1;  //!< 0: disable soft mute when seeking; 1: enable soft mute when seeking
     } refined;
     uint16_t raw;
 } bk_reg14;
@@ -637,38 +761,41 @@ typedef uint16_t bk_reg20; // Internal Register
  * 4) Unnamed bit-fields' types do not affect the alignment of a structure or union, although individual 
  *    bit-fields' member offsets obey the alignment constraints.   
  * 
+ * So, the fields are declared as uint16_t. With uint8_t, programType would not fit the first byte and would be 
+ * moved to the next storage unit (the union would be larger than the Block B register).
+ * 
  * @see also https://en.wikipedia.org/wiki/Radio_Data_System
  */
 typedef union
 {
     struct
     {
-        uint8_t address : 2;            // Depends on Group Type and Version codes. If 0A or 0B it is the Text Segment Address.
-        uint8_t DI : 1;                 // Decoder Controll bit
-        uint8_t MS : 1;                 // Music/Speech
-        uint8_t TA : 1;                 // Traffic Announcement
-        uint8_t programType : 5;        // PTY (Program Type) code
-        uint8_t trafficProgramCode : 1; // (TP) => 0 = No Traffic Alerts; 1 = Station gives Traffic Alerts
-        uint8_t versionCode : 1;        // (B0) => 0=A; 1=B
-        uint8_t groupType : 4;          // Group Type code.
+        uint16_t address : 2;            // Depends on Group Type and Version codes. If 0A or 0B it is the Text Segment Address.
+        uint16_t DI : 1;                 // Decoder Controll bit
+        uint16_t MS : 1;                 // Music/Speech
+        uint16_t TA : 1;                 // Traffic Announcement
+        uint16_t programType : 5;        // PTY (Program Type) code
+        uint16_t trafficProgramCode : 1; // (TP) => 0 = No Traffic Alerts; 1 = Station gives Traffic Alerts
+        uint16_t versionCode : 1;        // (B0) => 0=A; 1=B
+        uint16_t groupType : 4;          // Group Type code.
     } group0;
     struct
     {
-        uint8_t address : 4;            // Depends on Group Type and Version codes. If 2A or 2B it is the Text Segment Address.
-        uint8_t textABFlag : 1;         // Do something if it chanhes from binary "0" to binary "1" or vice-versa
-        uint8_t programType : 5;        // PTY (Program Type) code
-        uint8_t trafficProgramCode : 1; // (TP) => 0 = No Traffic Alerts; 1 = Station gives Traffic Alerts
-        uint8_t versionCode : 1;        // (B0) => 0=A; 1=B
-        uint8_t groupType : 4;          // Group Type code.
+        uint16_t address : 4;            // Depends on Group Type and Version codes. If 2A or 2B it is the Text Segment Address.
+        uint16_t textABFlag : 1;         // Do something if it chanhes from binary "0" to binary "1" or vice-versa
+        uint16_t programType : 5;        // PTY (Program Type) code
+        uint16_t trafficProgramCode : 1; // (TP) => 0 = No Traffic Alerts; 1 = Station gives Traffic Alerts
+        uint16_t versionCode : 1;        // (B0) => 0=A; 1=B
+        uint16_t groupType : 4;          // Group Type code.
     } group2;
     struct
     {
-        uint8_t content : 4;            // Depends on Group Type and Version codes.
-        uint8_t textABFlag : 1;         // Do something if it chanhes from binary "0" to binary "1" or vice-versa
-        uint8_t programType : 5;        // PTY (Program Type) code
-        uint8_t trafficProgramCode : 1; // (TP) => 0 = No Traffic Alerts; 1 = Station gives Traffic Alerts
-        uint8_t versionCode : 1;        // (B0) => 0=A; 1=B
-        uint8_t groupType : 4;          // Group Type code.
+        uint16_t content : 4;            // Depends on Group Type and Version codes.
+        uint16_t textABFlag : 1;         // Do something if it chanhes from binary "0" to binary "1" or vice-versa
+        uint16_t programType : 5;        // PTY (Program Type) code
+        uint16_t trafficProgramCode : 1; // (TP) => 0 = No Traffic Alerts; 1 = Station gives Traffic Alerts
+        uint16_t versionCode : 1;        // (B0) => 0=A; 1=B
+        uint16_t groupType : 4;          // Group Type code.
     } refined;
     bk_reg0d blockB;
 } bk_rds_blockb;
@@ -680,24 +807,325 @@ typedef union
  * This Structure uses blocks 2,3 and 5 (B,C,D)
  * 
  * ATTENTION: 
- * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
- * split minute and hour representation. 
+ * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, each block is a 16 bits 
+ * storage unit. So, it was necessary to split the hour (blocks C and D) and the MJD (blocks B and C) representation. 
+ * raw[0] is the block D, raw[1] is the block C and raw[2] is the block B.
  */
 typedef union
 {
     struct
     {
-        uint8_t offset : 5;       // Local Time Offset
-        uint8_t offset_sense : 1; // Local Offset Sign ( 0 = + , 1 = - )
-        uint8_t minute1 : 2;      // UTC Minutes - 2 bits less significant (void “Crosses boundary”).
-        uint8_t minute2 : 4;      // UTC Minutes - 4 bits  more significant  (void “Crosses boundary”)
-        uint8_t hour1 : 4;        // UTC Hours - 4 bits less significant (void “Crosses boundary”)
-        uint8_t hour2 : 1;        // UTC Hours - 4 bits more significant (void “Crosses boundary”)
-        uint32_t mjd : 17;        // Modified Julian Day Code
+        uint16_t offset : 5;       // Local Time Offset (multiples of 30 minutes)
+        uint16_t offset_sense : 1; // Local Offset Sign ( 0 = + , 1 = - )
+        uint16_t minute : 6;       // UTC Minutes
+        uint16_t hour1 : 4;        // UTC Hours - 4 bits less significant (void “Crosses boundary”)
+        uint16_t hour2 : 1;        // UTC Hours - 1 bit more significant (void “Crosses boundary”)
+        uint16_t mjd1 : 15;        // Modified Julian Day Code - 15 bits less significant (void “Crosses boundary”)
+        uint16_t mjd2 : 2;         // Modified Julian Day Code - 2 bits more significant (void “Crosses boundary”)
+        uint16_t : 14;
     } refined;
-    uint8_t raw[6];
+    uint16_t raw[3];
 } bk_rds_date_time;
 
+/**
+ * @ingroup GA01
+ * @brief Station found by scanBand
+ * @details Compact (4 bytes) entry of the scan station table. Use getScanFrequency to convert the channel to frequency.
+ */
+typedef struct
+{
+    uint16_t channel : 15; //!< Channel of the current band and space 
+    uint16_t stereo : 1;   //!< 1 = stereo 
+    uint8_t rssi;          //!< RSSI (dBuV)
+    uint8_t snr;           //!< SNR (dB)
+} bk_scan_station;
+
+/**
+ * @ingroup GA01
+ * @brief Seek validation thresholds of a band
+ * @details See setSeekValidation and setSeekValidationThreshold.
+ */
+typedef struct
+{
+    uint8_t rssi;   //!< Minimum average RSSI (dBuV)
+    uint8_t snr;    //!< Minimum average SNR (dB)
+    uint8_t stereo; //!< 1 = the stereo pilot must be present in most samples (FM only)
+} bk_seek_check;
+
+/**
+ * @ingroup GA01
+ * @brief Receiver state image used by saveState and restoreState
+ * @details Writable registers (0x02 to 0x08 and 0x10 to 0x1D) plus the band, space, frequency and volume fields.
+ */
+typedef struct
+{
+    uint16_t magic;              //!< BK_STATE_MAGIC
+    uint16_t reg02_08[7];        //!< Registers 0x02 to 0x08
+    uint16_t reg10_1D[14];       //!< Registers 0x10 to 0x1D
+    uint16_t frequency;          //!< Current frequency
+    uint16_t minimumFrequency;   //!< Band minimum frequency
+    uint16_t maximumFrequency;   //!< Band maximum frequency
+    uint16_t step;               //!< Frequency step 
+    uint8_t mode;                //!< MODE_FM or MODE_AM
+    uint8_t fmBand;              //!< FM band index
+    uint8_t amBand;              //!< AM band index
+    uint8_t fmSpace;             //!< FM space index
+    uint8_t amSpace;             //!< AM space index
+    uint8_t volume;              //!< Volume
+} bk_state;
+
+/**
+ * @ingroup GA01
+ * @brief Bus error counters
+ * @details See getBusErrors and resetBusErrors.
+ */
+typedef struct
+{
+    uint16_t nacks;    //!< Transactions not acknowledged by the device (each attempt)
+    uint16_t retries;  //!< Transactions repeated after a NACK
+    uint16_t failures; //!< Transactions given up after all retries
+    uint16_t timeouts; //!< Tunes aborted because STC did not come (see setTuneTimeout)
+} bk_bus_errors;
+
+#if defined(BK108X_STATS)
+/**
+ * @ingroup GA01
+ * @brief Instrumentation counters (BK108X_STATS builds only)
+ * @details Bucket i of a latency histogram counts the latencies with i significant bits in ms: bucket 0 = 0ms, 
+ * @details bucket 1 = 1ms, bucket 2 = 2 to 3ms, bucket 3 = 4 to 7ms and so on. The last bucket also counts the longer ones.
+ * @details See getStats and resetStats.
+ */
+typedef struct
+{
+    uint16_t reads[32];    //!< Registers read, per register (a burst read counts each register once)
+    uint16_t writes[32];   //!< Registers written, per register
+    uint32_t transactions; //!< Bus transactions (retries included)
+    uint32_t busTime;      //!< Time in the bus transactions, retries and backoff included (us)
+    uint32_t settleTime;   //!< Time in register settle delays (us, see setRegisterSettleTime)
+    uint32_t delayTime;    //!< Time in fixed delays (power up, band change) and blocking waits (ms)
+    uint32_t tunePolls;    //!< pollTune calls while a tune was in progress
+    uint32_t seekPolls;    //!< pollSeek calls while a seek was in progress
+    uint32_t scanPolls;    //!< pollScan calls while a scan was in progress
+    uint32_t seekRejects;  //!< Seek stops rejected by the seek validation (see setSeekValidation)
+    uint16_t tuneLatency[BK_STATS_BUCKETS]; //!< Tune (and scan step) latency histogram: start to STC
+    uint16_t seekLatency[BK_STATS_BUCKETS]; //!< Seek latency histogram: start to the end of the seek
+    uint16_t tuneMax;      //!< Longest tune (ms)
+    uint16_t seekMax;      //!< Longest seek (ms)
+} bk_stats;
+#endif
+
+/**
+ * @ingroup GA01
+ * @brief tick task slot
+ * @details See tick, setTaskPeriod and setTaskBudget.
+ */
+typedef struct
+{
+    uint16_t period; //!< Minimum time between two runs (ms); 0 = disabled
+    uint16_t budget; //!< Expected (worst case) run time (us)
+    uint32_t last;   //!< now_ms of the last run
+} bk_task;
+
+/**
+ * @ingroup GA01
+ * @brief Signal quality snapshot (registers 0x09 to 0x0B)
+ * @see BK108X::getSignalQuality, BK108X::refreshStatus
+ */
+typedef struct
+{
+    uint8_t rssi;          //!< RSSI (dBuV)
+    uint8_t snr;           //!< SNR (dB)
+    uint8_t stereo : 1;    //!< STEN; 1 = stereo
+    uint8_t rdsReady : 1;  //!< RDSR; 1 = new RDS group ready
+    uint8_t stc : 1;       //!< STC; 1 = seek/tune complete
+    uint8_t sfbl : 1;      //!< SF_BL; 1 = seek fail / band limit
+    uint8_t : 4;
+    uint16_t readChannel;  //!< READCHAN
+    uint32_t timestamp;    //!< millis() when the registers were read
+} bk_signal_quality;
+
+/**
+ * @ingroup GA01
+ * @brief Raw RDS group captured by captureRds
+ */
+typedef struct
+{
+    uint16_t block[4];  //!< Blocks A to D (registers 0x0C to 0x0F)
+    uint16_t status[2]; //!< Registers 0x0A and 0x0B when the group was read (RDS ready and READCHAN)
+} bk_rds_group;
+
+/**
+ * @ingroup GA01
+ * @brief Single producer / single consumer queue of raw RDS groups
+ * @details The producer (captureRds) and the consumer (processRds) need no lock: each side updates only its own index.
+ * @details The indexes are free running 8 bits counters and the depth is a power of 2. 
+ * @details The storage is provided by BK108XRdsRing. So, the queue depth does not change the BK108X class layout.
+ * @see BK108XRdsRing, BK108X::setRdsQueue
+ */
+class BK108XRdsQueue
+{
+protected:
+    bk_rds_group *buffer;
+    uint8_t mask;              //!< depth - 1
+    volatile uint8_t head = 0; //!< Written only by the producer
+    volatile uint8_t tail = 0; //!< Written only by the consumer
+    volatile uint16_t overflows = 0; //!< Groups dropped because the queue was full
+
+    BK108XRdsQueue(bk_rds_group *storage, uint8_t depth) : buffer(storage), mask(depth - 1) {};
+
+public:
+    /**
+     * @brief Adds a group (producer side)
+     * @return false if the queue is full (the group is dropped and the overflow counter is incremented)
+     */
+    inline bool push(const bk_rds_group &group)
+    {
+        uint8_t h = this->head;
+        if ((uint8_t)(h - this->tail) > this->mask)
+        {
+            this->overflows++;
+            return false;
+        }
+        this->buffer[h & this->mask] = group;
+        __sync_synchronize(); // The group must be stored before the consumer sees the new head
+        this->head = h + 1;
+        return true;
+    };
+
+    /**
+     * @brief Removes the oldest group (consumer side)
+     * @return false if the queue is empty
+     */
+    inline bool pop(bk_rds_group &group)
+    {
+        uint8_t t = this->tail;
+        if (t == this->head)
+            return false;
+        group = this->buffer[t & this->mask];
+        __sync_synchronize(); // The group must be copied before the producer sees the free slot
+        this->tail = t + 1;
+        return true;
+    };
+
+    /**
+     * @brief Drops all queued groups (consumer side)
+     */
+    inline void clear() { this->tail = this->head; };
+
+    /**
+     * @brief Number of queued groups
+     */
+    inline uint8_t available() { return (uint8_t)(this->head - this->tail); };
+
+    /**
+     * @brief Number of groups dropped because the consumer fell behind
+     */
+    inline uint16_t getOverflows() { return this->overflows; };
+
+    inline void resetOverflows() { this->overflows = 0; };
+    inline uint8_t depth() { return this->mask + 1; };
+};
+
+/**
+ * @ingroup GA01
+ * @brief RDS group queue with N groups of storage
+ * @details Declare it in your sketch to use a deeper queue than the built-in one:
+ * @code
+ * BK108X rx;
+ * BK108XRdsRing<16> rdsQueue;
+ *
+ * void setup() {
+ *   rx.setup(SDA_PIN, SCLK_PIN, RDS_INTERRUPT_PIN);
+ *   rx.setRdsQueue(rdsQueue);
+ * }
+ * @endcode
+ * @tparam N queue depth (number of groups). Must be a power of 2 up to 128.
+ */
+template <uint8_t N>
+class BK108XRdsRing : public BK108XRdsQueue
+{
+    static_assert(N > 0 && N <= 128 && (N & (N - 1)) == 0, "BK108XRdsRing depth must be a power of 2 up to 128");
+
+private:
+    bk_rds_group storage[N];
+
+public:
+    BK108XRdsRing() : BK108XRdsQueue(storage, N) {};
+};
+
+/**
+ * @ingroup GA01
+ * @brief RDS decoding buffers
+ * @details A member of BK108X by default. Build with BK108X_SLIM defined (compiler flag, e.g. -DBK108X_SLIM, so the 
+ * @details library and the sketch see the same class) on 2KB targets such as the ATmega328: the buffers (276 bytes 
+ * @details on AVR) leave the BK108X object and the sketch gives them with setRdsBuffers only if it uses the RDS. 
+ * @details There is no dynamic allocation. See extras/FOOTPRINT.md.
+ */
+typedef struct
+{
+    char buffer2A[65];           //!< Radio Text (group 2A)
+    char buffer2B[33];           //!< Radio Text (group 2B)
+    char buffer0A[9];            //!< Program Service name (groups 0A/0B)
+    char time[20];               //!< Clock Time (group 4A)
+    uint16_t lastGroup[4];       //!< Blocks A to D of the last captured RDS group (only new groups are queued)
+    bk_rds_group group;          //!< RDS group being decoded (the last one taken from the queue)
+    uint16_t fingerprint[BK_RDS_FINGERPRINTS]; //!< Fingerprint of the last group queued for each group type and segment
+    BK108XRdsRing<BK108X_RDS_QUEUE_DEPTH> queue; //!< Built-in RDS group queue
+} bk_rds_data;
+
+/**
+ * @ingroup GA01
+ * @brief Bus transport interface
+ * @details Carries the BK108X register transactions. By default the BK108X class uses its built-in bit-banged bus.
+ * @details Set a transport (see BK108X::setTransport) to use another bus implementation, for example BK108XPinBus
+ * @details (compile-time pins, see BK108XT.h).
+ * @details The register address is given as is: the transport sends the device address and (reg << 1) | rw.
+ */
+class BK108XTransport
+{
+public:
+    /**
+     * @brief Configures the bus (called by the BK108X setup functions)
+     * @return false if the bus could not be set up (the setup functions return false and do not power up the device)
+     */
+    virtual bool begin() { return true; };
+
+    /**
+     * @brief Writes length bytes starting at register reg in a single transaction (high byte first)
+     * @return false if the device did not acknowledge
+     */
+    virtual bool write(uint8_t reg, const uint8_t *data, uint8_t length) = 0;
+
+    /**
+     * @brief Reads length bytes starting at register reg in a single transaction (high byte first)
+     * @return false if the device did not acknowledge (data is not valid)
+     */
+    virtual bool read(uint8_t reg, uint8_t *data, uint8_t length) = 0;
+};
+
+#if defined(BK108X_FAST_IO)
+/**
+ * @ingroup GA01
+ * @brief MCU pin resolved to port registers and bit mask
+ * @details Used by the direct port I/O implementation of the I2C bus. See i2cInit.
+ */
+typedef struct
+{
+#if defined(__AVR__)
+    volatile uint8_t *out; //!< PORTx register
+    volatile uint8_t *in;  //!< PINx register
+    volatile uint8_t *dir; //!< DDRx register
+    uint8_t mask;          //!< Pin bit mask
+#elif defined(ARDUINO_ARCH_STM32)
+    GPIO_TypeDef *port;    //!< GPIO port
+    uint32_t mask;         //!< Pin bit mask
+    uint8_t shift;         //!< MODER bit position (2 * pin number)
+#else
+    uint32_t mask;         //!< Pin bit mask (GPIO 0 to 31)
+#endif
+} bk_io_pin;
+#endif
+
 /**
  * @ingroup GA01
  * @brief Converts 16 bits word to two bytes 
@@ -726,67 +1154,175 @@ class BK108X
 
 private:
 
-    uint8_t  i2cBuffer[32];
-
     uint16_t shadowRegisters[32]; //!< shadow registers 0x00  to 0x1F (0 - 31)
 
-    // Device registers map - References to the shadow registers
-    bk_reg00 *reg00 = (bk_reg00 *)&shadowRegisters[REG00]; //  0
-    bk_reg01 *reg01 = (bk_reg01 *)&shadowRegisters[REG01]; //  1
-    bk_reg02 *reg02 = (bk_reg02 *)&shadowRegisters[REG02]; //  2
-    bk_reg03 *reg03 = (bk_reg03 *)&shadowRegisters[REG03]; //  3
-    bk_reg04 *reg04 = (bk_reg04 *)&shadowRegisters[REG04]; //  4
-    bk_reg05 *reg05 = (bk_reg05 *)&shadowRegisters[REG05]; //  5
-    bk_reg06 *reg06 = (bk_reg06 *)&shadowRegisters[REG06]; //  6
-    bk_reg07 *reg07 = (bk_reg07 *)&shadowRegisters[REG07]; //  7
-    bk_reg08 *reg08 = (bk_reg08 *)&shadowRegisters[REG08]; //  8
-    bk_reg09 *reg09 = (bk_reg09 *)&shadowRegisters[REG09]; //  9
-    bk_reg0a *reg0a = (bk_reg0a *)&shadowRegisters[REG0A]; // 10
-    bk_reg0b *reg0b = (bk_reg0b *)&shadowRegisters[REG0B]; // 11
-    bk_reg0c *reg0c = (bk_reg0c *)&shadowRegisters[REG0C]; // 12
-    bk_reg0d *reg0d = (bk_reg0d *)&shadowRegisters[REG0D]; // 13
-    bk_reg0e *reg0e = (bk_reg0e *)&shadowRegisters[REG0E]; // 14
-    bk_reg0f *reg0f = (bk_reg0f *)&shadowRegisters[REG0F]; // 15
-    bk_reg10 *reg10 = (bk_reg10 *)&shadowRegisters[REG10]; // 16
-    bk_reg11 *reg11 = (bk_reg11 *)&shadowRegisters[REG11]; // 17
-    bk_reg12 *reg12 = (bk_reg12 *)&shadowRegisters[REG12]; // 18
-    bk_reg13 *reg13 = (bk_reg13 *)&shadowRegisters[REG13]; // 19
-    bk_reg14 *reg14 = (bk_reg14 *)&shadowRegisters[REG14]; // 20
-    bk_reg15 *reg15 = (bk_reg15 *)&shadowRegisters[REG15]; // 21
-    bk_reg16 *reg16 = (bk_reg16 *)&shadowRegisters[REG16]; // 22
-    bk_reg17 *reg17 = (bk_reg17 *)&shadowRegisters[REG17]; // 23
-    bk_reg18 *reg18 = (bk_reg18 *)&shadowRegisters[REG18]; // 24
-    bk_reg19 *reg19 = (bk_reg19 *)&shadowRegisters[REG19]; // 25
-    bk_reg1A *reg1A = (bk_reg1A *)&shadowRegisters[REG1A]; // 26
-    bk_reg1B *reg1b = (bk_reg1B *)&shadowRegisters[REG1B]; // 27
-    bk_reg1C *reg1c = (bk_reg1C *)&shadowRegisters[REG1C]; // 28
-    bk_reg1D *reg1d = (bk_reg1D *)&shadowRegisters[REG1D]; // 29
-    bk_reg1E *reg1e = (bk_reg1E *)&shadowRegisters[REG1E]; // 30
-    bk_reg1F *reg1f = (bk_reg1F *)&shadowRegisters[REG1F]; // 31
-
-    uint16_t fmStartBand[4] = {6400, 7400, 7600, 8700};  //!< Start FM band limit
-    uint16_t fmEndBand[4] = {10800, 7600, 9100, 10800};  //!< End FM band limit
-    uint16_t fmSpace[4] = {1, 5, 10, 20};             //!< FM channel space
-
-    uint16_t amStartBand[4] = {153, 520, 2300, 522}; //!< Start FM band limit
-    uint16_t amEndBand[4] = {279, 1710, 21850, 1710}; //!< End FM band limit
-    uint16_t amSpace[4] = {1, 5, 9, 10}; //!< AM channel space
-
-    int pin_sdio, pin_sclk; 
+    uint8_t registerSettle[32] = {0, 0, REGISTER_SETTLE_TIME, REGISTER_SETTLE_TIME}; //!< settle time (us) after writing each register
+
+    uint8_t updateLevel = 0;      //!< beginUpdate nesting level (0 = setters write immediately)
+    uint32_t dirtyRegisters = 0;  //!< one bit per register changed since beginUpdate
+#if !defined(BK108X_SLIM)
+    uint16_t updateSnapshot[32];  //!< shadowRegisters content when beginUpdate was called (identical values are skipped)
+#endif
+
+    void flushUpdate();
+
+    // Device registers map - Typed views of the shadow registers (computed casts: no RAM per register)
+    inline bk_reg00 *reg00() { return (bk_reg00 *)&shadowRegisters[REG00]; }; //  0
+    inline bk_reg01 *reg01() { return (bk_reg01 *)&shadowRegisters[REG01]; }; //  1
+    inline bk_reg02 *reg02() { return (bk_reg02 *)&shadowRegisters[REG02]; }; //  2
+    inline bk_reg03 *reg03() { return (bk_reg03 *)&shadowRegisters[REG03]; }; //  3
+    inline bk_reg04 *reg04() { return (bk_reg04 *)&shadowRegisters[REG04]; }; //  4
+    inline bk_reg05 *reg05() { return (bk_reg05 *)&shadowRegisters[REG05]; }; //  5
+    inline bk_reg06 *reg06() { return (bk_reg06 *)&shadowRegisters[REG06]; }; //  6
+    inline bk_reg07 *reg07() { return (bk_reg07 *)&shadowRegisters[REG07]; }; //  7
+    inline bk_reg08 *reg08() { return (bk_reg08 *)&shadowRegisters[REG08]; }; //  8
+    inline bk_reg09 *reg09() { return (bk_reg09 *)&shadowRegisters[REG09]; }; //  9
+    inline bk_reg0a *reg0a() { return (bk_reg0a *)&shadowRegisters[REG0A]; }; // 10
+    inline bk_reg0b *reg0b() { return (bk_reg0b *)&shadowRegisters[REG0B]; }; // 11
+    inline bk_reg0c *reg0c() { return (bk_reg0c *)&shadowRegisters[REG0C]; }; // 12
+    inline bk_reg0d *reg0d() { return (bk_reg0d *)&shadowRegisters[REG0D]; }; // 13
+    inline bk_reg0e *reg0e() { return (bk_reg0e *)&shadowRegisters[REG0E]; }; // 14
+    inline bk_reg0f *reg0f() { return (bk_reg0f *)&shadowRegisters[REG0F]; }; // 15
+    inline bk_reg10 *reg10() { return (bk_reg10 *)&shadowRegisters[REG10]; }; // 16
+    inline bk_reg11 *reg11() { return (bk_reg11 *)&shadowRegisters[REG11]; }; // 17
+    inline bk_reg12 *reg12() { return (bk_reg12 *)&shadowRegisters[REG12]; }; // 18
+    inline bk_reg13 *reg13() { return (bk_reg13 *)&shadowRegisters[REG13]; }; // 19
+    inline bk_reg14 *reg14() { return (bk_reg14 *)&shadowRegisters[REG14]; }; // 20
+    inline bk_reg15 *reg15() { return (bk_reg15 *)&shadowRegisters[REG15]; }; // 21
+    inline bk_reg16 *reg16() { return (bk_reg16 *)&shadowRegisters[REG16]; }; // 22
+    inline bk_reg17 *reg17() { return (bk_reg17 *)&shadowRegisters[REG17]; }; // 23
+    inline bk_reg18 *reg18() { return (bk_reg18 *)&shadowRegisters[REG18]; }; // 24
+    inline bk_reg19 *reg19() { return (bk_reg19 *)&shadowRegisters[REG19]; }; // 25
+    inline bk_reg1A *reg1A() { return (bk_reg1A *)&shadowRegisters[REG1A]; }; // 26
+    inline bk_reg1B *reg1b() { return (bk_reg1B *)&shadowRegisters[REG1B]; }; // 27
+    inline bk_reg1C *reg1c() { return (bk_reg1C *)&shadowRegisters[REG1C]; }; // 28
+    inline bk_reg1D *reg1d() { return (bk_reg1D *)&shadowRegisters[REG1D]; }; // 29
+    inline bk_reg1E *reg1e() { return (bk_reg1E *)&shadowRegisters[REG1E]; }; // 30
+    inline bk_reg1F *reg1f() { return (bk_reg1F *)&shadowRegisters[REG1F]; }; // 31
+
+    // Band limits and channel space of the current mode, band and space (see updateBandCache)
+    uint16_t bandStart = 6400;     //!< Start limit of the current band
+    uint16_t bandEnd = 10800;      //!< End limit of the current band
+    uint16_t bandSpace = 1;        //!< Channel space of the current band
+    uint16_t bandReciprocal = 0;   //!< ceil(2^18 / bandSpace) used by frequencyToChannel; 0 if bandSpace is 1
+
+    int pin_sdio = -1, pin_sclk = -1; 
+
+#if defined(BK108X_FAST_IO)
+    bk_io_pin ioSdio, ioSclk;  //!< SDIO and SCLK port/mask pairs resolved by i2cInit
+    bool fastIO = false;       //!< true if the direct port I/O is used (allowed and the pins could be resolved)
+    bool fastIOAllowed = true; //!< Direct port I/O preference (see setI2CFastIO)
+#endif
+    uint8_t i2cHalfPeriod = I2C_DEFAULT_HALF_PERIOD; //!< I2C half clock period in microseconds
+
+    BK108XTransport *transport = NULL; //!< Bus transport (NULL = built-in bit-banged bus)
+
+    bk_bus_errors busErrors = {0, 0, 0, 0};  //!< Bus error counters (see getBusErrors)
+    uint8_t busRetries = BK_BUS_RETRIES;      //!< Retries of a transaction not acknowledged
+    uint16_t busBackoff = BK_BUS_BACKOFF;     //!< Wait (us) before the first retry
+
+    bool busWrite(uint8_t reg, const uint8_t *data, uint8_t length);
+    bool busRead(uint8_t reg, uint8_t *data, uint8_t length);
+    bool i2cWrite(uint8_t reg, const uint8_t *data, uint8_t length);
+    bool i2cRead(uint8_t reg, uint8_t *data, uint8_t length);
+    bool busRetry(uint8_t attempt);
+    void waitMs(uint16_t ms_value);
+#if defined(BK108X_STATS)
+    bk_stats stats = {}; //!< Instrumentation counters (see getStats)
+    void statsLatency(uint16_t *histogram, uint16_t &maximum, uint32_t start);
+#endif
+
+    void sdioWrite(uint8_t value);
+    void sclkWrite(uint8_t value);
+    void sdioMode(uint8_t mode);
+    uint8_t sdioRead();
+    void i2cDelay();
 
 protected:
-    char rds_buffer2A[65]; //!<  RDS Radio Text buffer - Program Information
-    char rds_buffer2B[33]; //!<  RDS Radio Text buffer - Station Informaation
-    char rds_buffer0A[9];  //!<  RDS Basic tuning and switching information (Type 0 groups)
-    char rds_time[20];     //!<  RDS date time received information
-
     uint8_t rds_mode; 
 
+#if defined(BK108X_SLIM)
+    bk_rds_data *rdsData = NULL;        //!< RDS buffers given by the sketch; NULL = no RDS decoding (see setRdsBuffers)
+    static BK108XRdsRing<1> rdsNoQueue; //!< rdsQueue while no RDS buffers are given
+    BK108XRdsQueue *rdsQueue = &rdsNoQueue;     //!< Raw RDS groups waiting for processRds
+    inline bk_rds_data *rdsBuffers() { return this->rdsData; };
+#else
+    bk_rds_data rdsData;                        //!< RDS buffers
+    BK108XRdsQueue *rdsQueue = &rdsData.queue;  //!< Raw RDS groups waiting for processRds
+    inline bk_rds_data *rdsBuffers() { return &this->rdsData; };
+#endif
+    uint8_t rdsReceived = 0;        //!< BK_RDS_0A, BK_RDS_2A, BK_RDS_2B and BK_RDS_4A flags of the buffers with data
+    uint8_t rdsTextAB2A = 0;        //!< Text A/B flag of the last 2A group
+    uint8_t rdsTextAB2B = 0;        //!< Text A/B flag of the last 2B group
+    uint32_t rdsLastTime = 0;       //!< millis() of the last RDS group received
+    uint16_t rdsDuplicateDrops = 0; //!< Groups dropped by the fingerprint check
+    uint8_t rdsChanged = 0;         //!< BK_CHANGED_RDS_* flags not reported by update() yet
+
+    bk_signal_quality signalQuality;   //!< Last status snapshot (see refreshStatus)
+    bool signalQualityValid = false;   //!< false if signalQuality must be read again (for example, after a tune)
+    uint16_t statusMaxAge = BK_STATUS_MAX_AGE; //!< Max age of the snapshot used by getRssi, getSnr and isStereo
+    void storeSignalQuality();
+
+    uint16_t updateFrequency = 0;   //!< Frequency reported by the last update()
+    uint8_t updateRssi = 0xFF;      //!< RSSI bucket reported by the last update()
+    uint8_t updateSnr = 0xFF;       //!< SNR bucket reported by the last update()
+    uint8_t updateStereo = 0xFF;    //!< Stereo indicator reported by the last update()
+    uint8_t updateRssiStep = 4;     //!< RSSI bucket size (see setUpdateResolution)
+    uint8_t updateSnrStep = 2;      //!< SNR bucket size (see setUpdateResolution)
+    void (*updateCallback)(uint8_t changed) = NULL; //!< Function called by update() when something changed
+
+    // tick task slots (period ms, budget us): tune, seek, scan, RDS, status and user
+    bk_task tasks[BK_TASKS] = {{1, 1000, 0}, {1, 1000, 0}, {1, 2000, 0}, {40, 1500, 0}, {200, 1500, 0}, {0, 0, 0}, {1, 1500, 0}};
+    void (*userTask)() = NULL; //!< Function of the BK_TASK_USER slot (see setUserTask)
+    bool isTaskActive(uint8_t task);
+    void runTask(uint8_t task);
+    uint16_t getTaskPeriod(uint8_t task);
+
+    // Power management (see setLowPower, subscribe and standby)
+    bool lowPower = false;          //!< Low power mode: status and RDS polling only for the subscribers
+    uint16_t lowPowerPeriod = BK_LOW_POWER_PERIOD; //!< Status period (ms) of the low power mode
+    uint8_t subscriptions = 0;      //!< BK_CHANGED_* flags someone is interested in (see subscribe)
+    bool standbyMode = false;       //!< The receiver is in standby (see standby and resume)
+    uint16_t getStatusAge();
+
+    void processRdsGroup();
+    bool queueRdsGroup();
+    uint8_t getRdsFingerprint(const bk_rds_group &group, uint16_t &fingerprint);
+    void copyRdsGroup(bk_rds_group &group);
+
+    // Alternative frequencies (see setAf and pollAf)
+    uint16_t rdsPi = 0;             //!< PI of the current program (0 = unknown)
+    uint16_t rdsPiNext = 0;         //!< New PI seen once; it replaces rdsPi when the next group confirms it
+    bool afEnabled = false;         //!< AF following enabled
+    uint8_t afList[BK_AF_MAX];      //!< AF codes of the current program (frequency = 87.5MHz + code x 100kHz)
+    uint8_t afLevel[BK_AF_MAX];     //!< RSSI measured by the last probe of each AF; 0 = weak or rejected
+    uint8_t afCount = 0;            //!< Number of AFs in afList
+    uint8_t afRssi = BK_AF_RSSI;    //!< A round starts below this RSSI...
+    uint8_t afSnr = BK_AF_SNR;      //!< ...or below this SNR
+    uint8_t afMargin = BK_AF_MARGIN; //!< RSSI gain needed to move to an AF
+    uint8_t afState = 0;            //!< AF state machine (see BK108X.cpp)
+    uint8_t afIndex = 0;            //!< Next AF to probe
+    uint8_t afBest = 0;             //!< AF being checked for the PI
+    uint8_t afLowCount = 0;         //!< Consecutive weak status snapshots
+    uint8_t afHomeLevel = 0;        //!< RSSI of the current channel when the round started
+    uint16_t afHomeChannel = 0;     //!< Channel of the program when the round started
+    bool afMuted = false;           //!< The audio was muted by the AF following
+    uint32_t afLastSample = 0;      //!< Timestamp of the last status snapshot checked
+    uint32_t afTime = 0;            //!< millis() of the last AF tune, or the earliest time of the next step
+    uint8_t afReadTime = 0;         //!< Low byte of millis() of the last status read of the PI check
+    void collectAf(uint8_t code);
+    void abortAf();
+    void startAfTune(uint16_t channel);
+    bool isAfTuneDone();
+    void endAfTune(bool unmute);
+    uint8_t startAfProbe();
+    uint8_t rejectAf();
+
     int deviceAddress = I2C_DEVICE_ADDR;
 
-    uint32_t currentFrequency;
-    uint32_t minimumFrequency; 
-    uint32_t maximumFrequency; 
+    uint16_t currentFrequency;
+    uint16_t minimumFrequency; 
+    uint16_t maximumFrequency; 
 
     uint16_t currentChannel = 0;
     uint16_t currentStep = 1;
@@ -797,14 +1333,89 @@ protected:
     uint8_t currentMode = MODE_FM;
 
     uint8_t currentVolume = 0;
+
+    uint8_t tuneState = BK_TUNE_IDLE;  //!< Non-blocking tune state (see startTune and pollTune)
+    uint16_t tuneChannel = 0;          //!< Channel being tuned
+    uint32_t tuneStartTime = 0;        //!< millis() when the tune started
+    uint16_t tuneTimeout = MAX_TUNE_TIME; //!< Maximum time (ms) to wait for STC
+    bool tuneTargetMode = false;       //!< setFrequencyUp/Down only move the target (see setTuneTargetMode)
+
+    // Adaptive STC polling (see isStcPollDue)
+    uint8_t stcLatency[8] = {0};       //!< Learned tune latency (ms) per mode and band (AM bands 4 to 7); 0 = unknown
+    uint32_t stcNextPoll = 0;          //!< millis() of the next status read
+    uint8_t stcInterval = BK_STC_POLL_MIN;    //!< Current polling interval (ms)
+    uint8_t stcMaxInterval = BK_STC_POLL_MAX; //!< Maximum polling interval of the operation in progress
+    uint8_t stcReads = 0;              //!< Status reads of the operation in progress
+    void startStcPolling(uint8_t maxInterval, uint16_t firstPoll);
+    bool isStcPollDue();
+    void learnStcLatency();
+    void tuneTarget();
+    void (*tuneCallback)() = NULL;     //!< Function called when a tune completes
+
+    uint8_t seekState = BK_SEEK_IDLE;  //!< Non-blocking seek state (see startSeek and pollSeek)
+    uint32_t seekStartTime = 0;        //!< millis() when the seek started
+    uint16_t seekTimeout = MAX_SEEK_TIME; //!< Maximum seek time in ms
+    void (*seekCallback)() = NULL;     //!< Function called on each seek progress update
+
+    // Seek validation (see setSeekValidation)
+    bk_seek_check seekChecks[8] = {    //!< Thresholds per mode and band (AM bands 4 to 7)
+        {BK_SEEK_CHECK_RSSI, BK_SEEK_CHECK_SNR, 0}, {BK_SEEK_CHECK_RSSI, BK_SEEK_CHECK_SNR, 0},
+        {BK_SEEK_CHECK_RSSI, BK_SEEK_CHECK_SNR, 0}, {BK_SEEK_CHECK_RSSI, BK_SEEK_CHECK_SNR, 0},
+        {BK_SEEK_CHECK_RSSI, BK_SEEK_CHECK_SNR, 0}, {BK_SEEK_CHECK_RSSI, BK_SEEK_CHECK_SNR, 0},
+        {BK_SEEK_CHECK_RSSI, BK_SEEK_CHECK_SNR, 0}, {BK_SEEK_CHECK_RSSI, BK_SEEK_CHECK_SNR, 0}};
+    uint8_t seekCheckSamples = 0;      //!< Samples taken at each seek stop; 0 = validation disabled
+    uint8_t seekCheckInterval = BK_SEEK_CHECK_INTERVAL; //!< Interval (ms) between two samples
+    bool seekChecking = false;         //!< The seek stopped and the candidate is being sampled
+    uint8_t seekCheckCount = 0;        //!< Samples taken at the current stop
+    uint8_t seekCheckStereo = 0;       //!< Samples with the stereo pilot
+    uint16_t seekCheckRssi = 0;        //!< Sum of the RSSI samples
+    uint16_t seekCheckSnr = 0;         //!< Sum of the SNR samples
+    uint32_t seekCheckNext = 0;        //!< millis() of the next sample
+    uint8_t checkSeekStop();
+
+    uint16_t clearSeek();
+    void finishSeek();
+    void updateBandCache();
+    uint16_t channelToFrequency(uint16_t channel);
+    uint16_t frequencyToChannel(uint16_t frequency);
+
+    bk_scan_station scanStations[BK_SCAN_MAX_STATIONS]; //!< Stations found by the last scan
+    uint8_t scanCount = 0;             //!< Number of stations in scanStations
+    uint8_t scanState = BK_SCAN_IDLE;  //!< Non-blocking scan state (see startScan and pollScan)
+    uint16_t scanChannel = 0;          //!< Channel being sampled
+    uint16_t scanLastChannel = 0;      //!< Last channel of the scan
+    uint16_t scanSavedChannel = 0;     //!< Channel restored when the scan finishes
+    uint8_t scanRssi = 20;             //!< Minimum RSSI of a station (see setScanThreshold)
+    uint8_t scanSnr = 4;               //!< Minimum SNR of a station (see setScanThreshold)
+    uint8_t scanSeekRssi = 0;          //!< Seek RSSI threshold (SEEKTH) restored when the scan finishes
+    uint8_t scanSeekSnr = 0;           //!< Seek SNR threshold (SKSNR) restored when the scan finishes
+    bool scanSeeking = false;          //!< true after the first channel: the device seeks to the next station
+
+    void addScanStation();
+    void startScanSeek();
+    void setScanSeekThreshold(uint8_t rssiValue, uint8_t snrValue);
+
     int rdsInterruptPin = -1;
     int seekInterruptPin = -1;
+    uint32_t lastStatusPoll = 0;             //!< millis() of the last status read while waiting for an interrupt
+
+    volatile uint8_t interruptFlags = 0;     //!< BK_IRQ_STC and BK_IRQ_RDS flags set by the interrupt service routines
+    int8_t interruptSlot = -1;               //!< Slot of interruptOwners used by this receiver (-1 = none)
+    static BK108X *volatile interruptOwners[BK_IRQ_SLOTS]; //!< Receiver served by the ISRs of each slot
+    template <uint8_t SLOT, uint8_t FLAGS>
+    static void interruptHandler();
+    static void (*const interruptHandlers[BK_IRQ_SLOTS][3])(); //!< ISRs of each slot: seek, RDS and shared pin
+    void setupInterrupts();
+    void releaseInterrupts();
+    bool hasInterrupt(uint8_t flag, int pin);
     int oscillatorType = OSCILLATOR_TYPE_CRYSTAL;
     uint16_t maxDelayAftarCrystalOn = MAX_DELAY_AFTER_OSCILLATOR;
 
 
 public:
     void setI2C(uint8_t i2c_addr = I2C_DEVICE_ADDR);
+    void setI2CSpeed(uint16_t khz);
+    void setI2CFastIO(bool value);
     void i2cInit(int pin_sdio, int pin_sclk);
     void i2cBeginTransaction();
     void i2cEndTransaction();
@@ -815,12 +1426,25 @@ public:
     uint8_t i2cReadByte();
     void writeRegister(uint8_t reg,uint16_t vakue);
     uint16_t readRegister(uint8_t reg);
+    bool writeRegisters(uint8_t first, uint8_t count, const uint16_t *in);
+    bool readRegisters(uint8_t first, uint8_t count, uint16_t *out);
 
     void reset();
     void powerUp();
     void powerDown();
+    void standby();
+    void resume();
+
+    /**
+     * @ingroup GA03
+     * @brief Checks if the receiver is in standby (see standby)
+     */
+    inline bool isStandby() { return this->standbyMode; };
     void waitAndFinishTune();
 
+    void saveState(bk_state &state);
+    bool restoreState(const bk_state &state);
+
 
 
     /**
@@ -831,17 +1455,100 @@ public:
      */
     inline void setI2CAddress(int bus_addr) { this->deviceAddress = bus_addr; };
 
+    /**
+     * @ingroup GA02
+     * @brief Sets the bus transport
+     * @details Call it before setup. The setup functions call transport->begin(). Use NULL to go back to the 
+     * @details built-in bit-banged bus.
+     * @param transport  bus implementation (see BK108XTransport)
+     */
+    inline void setTransport(BK108XTransport *transport) { this->transport = transport; };
+
+    /**
+     * @ingroup GA02
+     * @brief Sets the retry policy of the transactions not acknowledged by the device
+     * @details A transaction is repeated up to retries times. The wait before each retry starts at backoff_us and 
+     * @details doubles at each retry. 
+     * @param retries     number of retries (default BK_BUS_RETRIES; 0 = no retry)
+     * @param backoff_us  wait before the first retry in microseconds (default BK_BUS_BACKOFF)
+     */
+    inline void setBusRetry(uint8_t retries, uint16_t backoff_us = BK_BUS_BACKOFF)
+    {
+        this->busRetries = retries;
+        this->busBackoff = backoff_us;
+    };
+
+    /**
+     * @ingroup GA02
+     * @brief Gets the bus error counters (NACKs, retries, failures and tune timeouts)
+     * @details Useful to detect wiring or power problems in the field.
+     */
+    inline const bk_bus_errors &getBusErrors() { return this->busErrors; };
+
+    /**
+     * @ingroup GA02
+     * @brief Clears the bus error counters
+     */
+    inline void resetBusErrors() { memset(&this->busErrors, 0, sizeof(this->busErrors)); };
+
+#if defined(BK108X_STATS)
+    /**
+     * @ingroup GA02
+     * @brief Gets the instrumentation counters (BK108X_STATS builds only)
+     * @details The counters start at zero. Call resetStats before the code to be profiled.
+     * @code
+     * rx.resetStats();
+     * rx.setFM(8400, 10800, 10390, 10);
+     * const bk_stats &st = rx.getStats();
+     * Serial.print("REG02 writes: "); Serial.println(st.writes[REG02]);
+     * Serial.print("bus us: ");       Serial.println(st.busTime);
+     * @endcode
+     * @see bk_stats
+     */
+    inline const bk_stats &getStats() { return this->stats; };
+
+    /**
+     * @ingroup GA02
+     * @brief Clears the instrumentation counters (BK108X_STATS builds only)
+     */
+    inline void resetStats() { memset(&this->stats, 0, sizeof(this->stats)); };
+#endif
+
     /**
      * @ingroup GA03
      * @brief Set the Delay After Crystal On (default 500ms)
-     * 
+     * @details Maximum time restoreState waits for the oscillator to settle (the first tune to complete).
      * @param ms_value  Value in milliseconds 
      */
-    inline void setDelayAfterCrystalOn(uint8_t ms_value) { maxDelayAftarCrystalOn = ms_value; };
+    inline void setDelayAfterCrystalOn(uint16_t ms_value) { maxDelayAftarCrystalOn = ms_value; };
 
     uint16_t getRegister(uint8_t reg);
     void setRegister(uint8_t reg, uint16_t value);
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the settle time used after writing a given register  
+     * @details By default only the Power Configuration (0x02) and Channel (0x03) registers wait REGISTER_SETTLE_TIME (250us).
+     * @details The other registers (volume, mute thresholds, AFC etc) are written without any delay. 
+     * @see setRegister, writeRegisters
+     * @param reg  register (0x00 to 0x1F)
+     * @param us   settle time in microseconds (0 to 255)
+     */
+    inline void setRegisterSettleTime(uint8_t reg, uint8_t us) { registerSettle[reg & 0x1F] = us; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the settle time used after writing a given register  
+     * @param reg  register (0x00 to 0x1F)
+     * @return settle time in microseconds 
+     */
+    inline uint8_t getRegisterSettleTime(uint8_t reg) { return registerSettle[reg & 0x1F]; };
+
     bk_reg0a getStatus();
+    void beginUpdate();
+    void commit();
+    void getAllRegisters();
+    void setAllRegisters();
 
     /**
      * @ingroup GA03
@@ -859,12 +1566,12 @@ public:
      * @brief Sets a given value to the Shadown Register
      * @details You have to call setAllRegisters() after setting the Shadow Registers to store the value into the device.
      * @see setAllRegisters, getAllRegisters, getShadownRegister, getStatus
-     * @param register_number  register index (from 0x00 to 0x0F)
+     * @param register_number  register index (from 0x00 to 0x1F)
      * @param value            16 bits word with the content of the register 
      */
     void setShadownRegister(uint8_t register_number, uint16_t value)
     {
-        if (register_number > 0x0F)
+        if (register_number > 0x1F)
             return;
         shadowRegisters[register_number] = value;
     };
@@ -872,7 +1579,10 @@ public:
     uint16_t getDeviceId();
     uint16_t getChipId();
 
-    void setup(int sda_pin, int sclk_pin, int rdsInterruptPin = -1, int seekInterruptPin = -1, uint8_t oscillator_type = OSCILLATOR_TYPE_CRYSTAL);
+    ~BK108X();
+
+    bool setup(int sda_pin, int sclk_pin, int rdsInterruptPin = -1, int seekInterruptPin = -1, uint8_t oscillator_type = OSCILLATOR_TYPE_CRYSTAL);
+    bool setup(int sda_pin, int sclk_pin, const bk_state &state, int rdsInterruptPin = -1, int seekInterruptPin = -1);
     
     void setFM(uint16_t minimum_frequency, uint16_t maximum_frequency, uint16_t default_frequency, uint16_t step);
     void setAM(uint16_t minimum_frequency, uint16_t maximum_frequency, uint16_t default_frequency, uint16_t step, uint16_t am_space = 0);
@@ -885,6 +1595,30 @@ public:
      */
     inline uint8_t getCurrentMode() { return this->currentMode; };
 
+    /**
+     * @ingroup GA03
+     * @brief Gets the channel space of the current band and space (10kHz unit on FM; kHz on AM)
+     */
+    inline uint16_t getChannelSpace() { return this->bandSpace; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the minimum frequency set by setFM or setAM
+     */
+    inline uint16_t getMinimumFrequency() { return this->minimumFrequency; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the maximum frequency set by setFM or setAM
+     */
+    inline uint16_t getMaximumFrequency() { return this->maximumFrequency; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the step used by setFrequencyUp and setFrequencyDown (set by setFM or setAM)
+     */
+    inline uint16_t getStep() { return this->currentStep; };
+
     /**
      * @ingroup GA03
      * @brief Sets the Stereo Threshold of Pilotto Strength 
@@ -892,8 +1626,8 @@ public:
      * @param value  0 ~ 7
      */
     inline void setStereoThresholdPilotStrength(uint8_t value) {
-        reg04->refined.PILOTS = value;
-        setRegister(REG04,reg04->raw);
+        reg04()->refined.PILOTS = value;
+        setRegister(REG04,reg04()->raw);
     }
 
     /**
@@ -905,8 +1639,8 @@ public:
      */
     inline void setFmDeemphasis(uint8_t de)
     {
-        reg04->refined.DE = de;
-        setRegister(REG04, reg04->raw);
+        reg04()->refined.DE = de;
+        setRegister(REG04, reg04()->raw);
     }
 
     /**
@@ -917,8 +1651,8 @@ public:
      */
     inline void setTimeCallStrengthPilot(uint8_t value)
     {
-        reg04->refined.TCPILOT = value;
-        setRegister(REG04, reg04->raw);
+        reg04()->refined.TCPILOT = value;
+        setRegister(REG04, reg04()->raw);
     }
 
     /**
@@ -936,8 +1670,8 @@ public:
      * @param value See table above
      */
     inline void setGpio2( uint8_t value) {
-        reg04->refined.GPIO2 = value;
-        setRegister(REG04,reg04->raw);
+        reg04()->refined.GPIO2 = value;
+        setRegister(REG04,reg04()->raw);
     }
 
     /**
@@ -956,8 +1690,8 @@ public:
      */
     inline void setGpio3(uint8_t value)
     {
-        reg04->refined.GPIO3 = value;
-        setRegister(REG04, reg04->raw);
+        reg04()->refined.GPIO3 = value;
+        setRegister(REG04, reg04()->raw);
     }
 
     /**
@@ -968,8 +1702,8 @@ public:
      */
     inline void setAfc(bool value)
     {
-        reg08->refined.AFCEN = value;
-        setRegister(REG08, reg08->raw);
+        reg08()->refined.AFCEN = value;
+        setRegister(REG08, reg08()->raw);
     }
 
     /**
@@ -979,8 +1713,8 @@ public:
      * @param value if True, it enables AFC Invert.
      */
     inline void setAfcInvert(bool value) {
-        reg04->refined.AFCINV = value;
-        setRegister(REG04, reg04->raw);
+        reg04()->refined.AFCINV = value;
+        setRegister(REG04, reg04()->raw);
     }
 
     /**
@@ -991,8 +1725,8 @@ public:
      */
     inline void setAfcRssiSnrCalculateRate(uint8_t value)
     {
-        reg08->refined.TCSEL =  value;
-        setRegister(REG08, reg08->raw);
+        reg08()->refined.TCSEL =  value;
+        setRegister(REG08, reg08()->raw);
     }
 
     /**
@@ -1003,8 +1737,8 @@ public:
      */
     inline void setAfcThreshold(uint8_t value)
     {
-        reg08->refined.SEL25K =  value;
-        setRegister(REG08, reg08->raw);
+        reg08()->refined.SEL25K =  value;
+        setRegister(REG08, reg08()->raw);
     }
 
     /**
@@ -1015,8 +1749,8 @@ public:
      */
     inline void setAfcAve(uint8_t value)
     {
-        reg08->refined.AVE =  value;
-        setRegister(REG08, reg08->raw);
+        reg08()->refined.AVE =  value;
+        setRegister(REG08, reg08()->raw);
     }
 
     /**
@@ -1027,8 +1761,8 @@ public:
      */
     inline void setAfcVar(uint8_t value)
     {
-        reg08->refined.VAR =  value;
-        setRegister(REG08, reg08->raw);
+        reg08()->refined.VAR =  value;
+        setRegister(REG08, reg08()->raw);
     }
 
     /**
@@ -1039,8 +1773,8 @@ public:
      */
     inline void setAfcRange(uint8_t value)
     {
-        reg08->refined.RANGE =  value;
-        setRegister(REG08, reg08->raw);
+        reg08()->refined.RANGE =  value;
+        setRegister(REG08, reg08()->raw);
     }
 
     /**
@@ -1051,8 +1785,8 @@ public:
      */
     inline void setAfcRssiThreshold(uint8_t value)
     {
-        reg08->refined.AFCRSSIT =  value;
-        setRegister(REG08, reg08->raw);
+        reg08()->refined.AFCRSSIT =  value;
+        setRegister(REG08, reg08()->raw);
     }
 
 
@@ -1065,9 +1799,176 @@ public:
     uint16_t getRealFrequency();
     uint16_t getRealChannel();
     void setChannel(uint16_t channel);
+
+    void startTune(uint16_t frequency);
+    void startTuneChannel(uint16_t channel);
+    uint8_t pollTune();
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the function called when a tune completes
+     * @details The function is called by pollTune (and by the blocking tune functions) right after STC becomes 1.
+     * @see startTune, pollTune
+     * @param callback function without parameters. Set NULL to disable it.
+     */
+    inline void setTuneCallback(void (*callback)()) { this->tuneCallback = callback; };
+
+    /**
+     * @ingroup GA03
+     * @brief Checks if a tune started by startTune is still in progress
+     * @return true if the device has not completed the tune yet 
+     */
+    inline bool isTuning() { return this->tuneState == BK_TUNE_IN_PROGRESS; };
     inline void seekStation(uint8_t seek_mode, uint8_t direction) {seekHardware(seek_mode, direction); };
     void seekHardware(uint8_t seek_mode, uint8_t direction);
     void seekSoftware(uint8_t seek_mode, uint8_t direction, void (*showFunc)() = NULL);
+
+    void startSeek(uint8_t seek_mode, uint8_t direction);
+    uint8_t pollSeek();
+    void cancelSeek();
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the function called on each seek progress update 
+     * @details The function is called by pollSeek after updating the current frequency (see getFrequency) with the 
+     * @details channel the device is checking, and once more when the seek finishes.
+     * @param callback function without parameters. Set NULL to disable it.
+     */
+    inline void setSeekCallback(void (*callback)()) { this->seekCallback = callback; };
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the maximum time of a seek
+     * @details If the device does not complete the seek in this time, the seek is stopped on the current channel.
+     * @param ms_value timeout in milliseconds (default MAX_SEEK_TIME) 
+     */
+    inline void setSeekTimeout(uint16_t ms_value) { this->seekTimeout = ms_value; };
+
+    /**
+     * @ingroup GA03
+     * @brief Enables the validation of the seek stops
+     * @details The device stops the seek on the first channel above the seek threshold (see setSeekThreshold), and a
+     * @details noise burst or an adjacent strong station can stop it on an empty channel. With the validation enabled,
+     * @details pollSeek samples RSSI, SNR and the stereo pilot of each stop and continues seeking in the same direction
+     * @details if the averages are below the thresholds of the band (see setSeekValidationThreshold). The samples do
+     * @details not block: they are taken by the next pollSeek calls. The seek timeout (see setSeekTimeout) still 
+     * @details bounds the whole seek, rejected stops included.
+     * @code
+     * rx.setSeekValidation();                              // 3 samples, 10ms apart
+     * rx.setSeekValidationThreshold(MODE_FM, 0, 25, 10, true); // FM band 0: 25dBuV, 10dB and stereo
+     * rx.seekHardware(BK_SEEK_WRAP, BK_SEEK_UP);
+     * @endcode
+     * @param samples  samples taken at each stop (default BK_SEEK_CHECK_SAMPLES). 0 disables the validation.
+     * @param interval interval in ms between two samples (default BK_SEEK_CHECK_INTERVAL)
+     */
+    inline void setSeekValidation(uint8_t samples = BK_SEEK_CHECK_SAMPLES, uint8_t interval = BK_SEEK_CHECK_INTERVAL) { this->seekCheckSamples = samples; this->seekCheckInterval = interval; };
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the seek validation thresholds of a band
+     * @details The defaults are BK_SEEK_CHECK_RSSI and BK_SEEK_CHECK_SNR without stereo, on all bands.
+     * @see setSeekValidation
+     * @param mode   MODE_FM or MODE_AM
+     * @param band   band index (see setBand)
+     * @param rssi   minimum average RSSI (dBuV)
+     * @param snr    minimum average SNR (dB)
+     * @param stereo true = the stereo pilot must be present in most samples. Ignored on AM.
+     */
+    inline void setSeekValidationThreshold(uint8_t mode, uint8_t band, uint8_t rssi, uint8_t snr, bool stereo = false) { this->seekChecks[((mode & 1) << 2) | (band & 3)] = {rssi, snr, stereo}; };
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the maximum time to wait for STC after starting a tune
+     * @details If STC does not come in this time, pollTune returns BK_TUNE_TIMEOUT and the tune is dropped.
+     * @param ms_value timeout in milliseconds (default MAX_TUNE_TIME)
+     */
+    inline void setTuneTimeout(uint16_t ms_value) { this->tuneTimeout = ms_value; };
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the tune target mode of setFrequencyUp and setFrequencyDown
+     * @details In this mode, setFrequencyUp and setFrequencyDown do not wait for the device. They move the target 
+     * @details frequency (getFrequency) and return. If no tune is in progress, the target is tuned at once; otherwise, 
+     * @details the device is tuned to the latest target when the tune in progress completes. So, a fast encoder 
+     * @details does not queue one full tune per detent: the intermediate channels are dropped.
+     * @details pollTune (or tick) has to be called in the loop. It returns BK_TUNE_DONE (and calls the tune callback)
+     * @details only when the device is on the latest target.
+     * @code
+     * rx.setTuneTargetMode(true);
+     * .
+     * void loop() {
+     *   if (encoderCount != 0) {
+     *      (encoderCount > 0) ? rx.setFrequencyUp() : rx.setFrequencyDown();
+     *      encoderCount = 0;
+     *      showFrequency();   // getFrequency() is already the target
+     *   }
+     *   rx.pollTune();
+     * }
+     * @endcode
+     * @param value true = tune target mode; false = setFrequencyUp/Down wait for each tune (default)
+     */
+    inline void setTuneTargetMode(bool value) { this->tuneTargetMode = value; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the tune latency (start to STC) learned for the current mode and band
+     * @details Used by the adaptive STC polling: the first status read of a tune is done a little before this time.
+     * @return latency in ms (0 = nothing learned yet)
+     */
+    inline uint8_t getTuneLatency() { return this->stcLatency[(this->currentMode << 2) | (reg05()->refined.BAND & 3)]; };
+
+    /**
+     * @ingroup GA03
+     * @brief Checks if a seek started by startSeek is still in progress
+     * @return true if the device is seeking
+     */
+    inline bool isSeeking() { return this->seekState == BK_SEEK_IN_PROGRESS; };
+
+    uint8_t scanBand();
+    void startScan();
+    void startScan(uint16_t minimum_frequency, uint16_t maximum_frequency);
+    uint8_t pollScan();
+    void cancelScan();
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the minimum RSSI and SNR of a station found by scanBand 
+     * @details During the scan, they are also the device seek thresholds (see setSeekThreshold). 
+     * @param rssiValue minimum RSSI (dBuV; default 20)
+     * @param snrValue  minimum SNR (dB; default 4)
+     */
+    inline void setScanThreshold(uint8_t rssiValue, uint8_t snrValue) { this->scanRssi = rssiValue; this->scanSnr = snrValue; };
+
+    /**
+     * @ingroup GA03
+     * @brief Checks if a scan started by startScan is still in progress
+     * @return true if the band is being scanned
+     */
+    inline bool isScanning() { return this->scanState == BK_SCAN_IN_PROGRESS; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the number of stations found by the last scan
+     * @return number of entries of the station table (up to BK_SCAN_MAX_STATIONS)
+     */
+    inline uint8_t getScanCount() { return this->scanCount; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets a station found by the last scan
+     * @details Stations are sorted by channel. 
+     * @param idx index (0 to getScanCount() - 1)
+     * @return pointer to the station entry
+     */
+    inline bk_scan_station *getScanStation(uint8_t idx) { return &this->scanStations[idx]; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the frequency of a station found by the last scan
+     * @param idx index (0 to getScanCount() - 1)
+     * @return frequency (10kHz unit on FM; kHz on AM)
+     */
+    inline uint16_t getScanFrequency(uint8_t idx) { return channelToFrequency(this->scanStations[idx].channel); };
     void setSeekThreshold(uint8_t rssiValue, uint8_t snrValue);
 
     void setBand(uint8_t band = 1);
@@ -1111,4 +2012,251 @@ public:
     char *getRdsText2B(void);
     char *getRdsTime();
     bool getRdsSync();
-};
\ No newline at end of file
+    void clearRdsBuffer();
+
+    bool captureRds();
+    uint8_t processRds(uint8_t maxGroups = 255);
+
+    /**
+     * @ingroup GA04
+     * @brief Replaces the built-in RDS group queue 
+     * @details Use it when the loop may take longer than BK108X_RDS_QUEUE_DEPTH groups (~88ms each) to call processRds.
+     * @see BK108XRdsRing
+     * @param queue a BK108XRdsRing declared in your sketch (it must exist while the receiver is used)
+     */
+    inline void setRdsQueue(BK108XRdsQueue &queue) { this->rdsQueue = &queue; queue.clear(); };
+
+#if defined(BK108X_SLIM)
+    void setRdsBuffers(bk_rds_data *data);
+#endif
+
+    /**
+     * @ingroup GA04
+     * @brief Gets the number of RDS groups dropped because processRds was not called in time
+     * @details If it keeps growing, call processRds more often or use a deeper queue (see setRdsQueue).
+     * @return number of overflows since the last resetRdsOverflows 
+     */
+    inline uint16_t getRdsOverflows() { return this->rdsQueue->getOverflows(); };
+    inline void resetRdsOverflows() { this->rdsQueue->resetOverflows(); };
+
+    /**
+     * @ingroup GA04
+     * @brief Gets the number of RDS groups waiting for processRds
+     */
+    inline uint8_t getRdsQueued() { return this->rdsQueue->available(); };
+
+    /**
+     * @ingroup GA04
+     * @brief Gets the number of RDS groups dropped because they were equal to the last one of the same type and segment
+     */
+    inline uint16_t getRdsDuplicateDrops() { return this->rdsDuplicateDrops; };
+
+    uint8_t update();
+
+    uint8_t pollAf();
+    bool isAfChecking();
+
+    /**
+     * @ingroup GA04
+     * @brief Enables the RDS alternative frequency (AF) following
+     * @details The AF codes of the 0A groups are collected for the PI of the current program. When the status
+     * @details snapshot (see update) stays below the AF threshold (see setAfThreshold), pollAf checks the AFs one by
+     * @details one: the audio is muted, the receiver tunes to the AF, measures it and tunes back. So, each probe stops 
+     * @details the audio for about two tune times (tens of ms). After the round, the best AF (if better than the 
+     * @details current channel by the margin) is tuned and used as soon as a RDS group confirms the PI.
+     * @details pollAf is run by tick (BK_TASK_AF). The tick RDS and status tasks are suspended while the receiver 
+     * @details is out of the current channel. The RDS must be enabled (see setRds).
+     * @code
+     * rx.setRds(true);
+     * rx.setAf(true);
+     * .
+     * void loop() {
+     *   rx.tick(millis());
+     * }
+     * @endcode
+     * @see pollAf, setAfThreshold, getAfCount
+     * @param value true = enabled
+     */
+    inline void setAf(bool value) { this->afEnabled = value; if (!value) abortAf(); };
+
+    /**
+     * @ingroup GA04
+     * @brief Sets when the alternative frequencies are checked and when one is used
+     * @param rssi   a check round starts when the RSSI (dBuV) stays below this value (default BK_AF_RSSI)...
+     * @param snr    ...or the SNR (dB) stays below this value (default BK_AF_SNR)
+     * @param margin an AF is used if its RSSI is above the current one by this margin in dB (default BK_AF_MARGIN)
+     */
+    inline void setAfThreshold(uint8_t rssi, uint8_t snr, uint8_t margin = BK_AF_MARGIN) { this->afRssi = rssi; this->afSnr = snr; this->afMargin = margin; };
+
+
+    /**
+     * @ingroup GA04
+     * @brief Gets the RDS Program Identification of the current program (0 = not received yet)
+     */
+    inline uint16_t getRdsPi() { return this->rdsPi; };
+
+    /**
+     * @ingroup GA04
+     * @brief Gets the number of alternative frequencies collected for the current program
+     */
+    inline uint8_t getAfCount() { return this->afCount; };
+
+    /**
+     * @ingroup GA04
+     * @brief Gets an alternative frequency collected for the current program
+     * @param idx index (0 to getAfCount() - 1)
+     * @return frequency (10kHz unit)
+     */
+    inline uint16_t getAfFrequency(uint8_t idx) { return 8750 + this->afList[idx] * 10; };
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the function called by update() when something changed
+     * @param callback function with the BK_CHANGED_* flags as parameter. Set NULL to disable it.
+     */
+    inline void setUpdateCallback(void (*callback)(uint8_t changed)) { this->updateCallback = callback; };
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the RSSI and SNR bucket sizes used by update()
+     * @details BK_CHANGED_RSSI (or BK_CHANGED_SNR) is raised only when the value moves to another bucket. 
+     * @details It avoids redrawing a signal meter for every 1dB of noise.
+     * @param rssiStep  RSSI bucket size in dBuV (default 4; 1 = any change)
+     * @param snrStep   SNR bucket size in dB (default 2; 1 = any change)
+     */
+    inline void setUpdateResolution(uint8_t rssiStep, uint8_t snrStep) { this->updateRssiStep = (rssiStep) ? rssiStep : 1; this->updateSnrStep = (snrStep) ? snrStep : 1; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the RSSI of the status snapshot (read by the last update() or refreshStatus; no I2C transaction)
+     */
+    inline uint8_t getUpdatedRssi() { return this->signalQuality.rssi; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the SNR of the status snapshot (read by the last update() or refreshStatus; no I2C transaction)
+     */
+    inline uint8_t getUpdatedSnr() { return this->signalQuality.snr; };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the stereo indicator of the status snapshot (read by the last update() or refreshStatus; no I2C transaction)
+     */
+    inline bool isUpdatedStereo() { return this->signalQuality.stereo; };
+
+    bool refreshStatus(uint16_t maxAge = 0);
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the signal quality snapshot
+     * @details The registers 0x09 to 0x0B are read in a single transaction only if the snapshot is older than maxAge.
+     * @code
+     * bk_signal_quality *sq = rx.getSignalQuality(50); // At most one I2C transaction every 50ms
+     * Serial.print(sq->rssi);
+     * Serial.print(sq->snr);
+     * Serial.print(sq->stereo);
+     * @endcode
+     * @param maxAge  maximum age of the snapshot in ms (0 = always read the registers)
+     * @return pointer to the snapshot
+     */
+    inline bk_signal_quality *getSignalQuality(uint16_t maxAge = 0) { refreshStatus(maxAge); return &this->signalQuality; };
+
+    /**
+     * @ingroup GA03
+     * @brief Sets the max age of the snapshot used by getRssi, getSnr and isStereo
+     * @details Calling these functions together inside this window costs a single I2C transaction.
+     * @param ms_value  max age in ms (default BK_STATUS_MAX_AGE; 0 = every call reads the registers)
+     */
+    inline void setStatusMaxAge(uint16_t ms_value) { this->statusMaxAge = ms_value; };
+
+    /**
+     * @ingroup GA03
+     * @brief Invalidates the status snapshot. The next status function reads the registers.
+     */
+    inline void invalidateStatus() { this->signalQualityValid = false; };
+
+    uint8_t tick(uint32_t now_ms, uint16_t budget_us = BK_TICK_BUDGET);
+
+    /**
+     * @ingroup GA07
+     * @brief Sets the period of a tick task
+     * @details Defaults: BK_TASK_TUNE, BK_TASK_SEEK and BK_TASK_SCAN 1ms (the status reads are paced by the adaptive
+     * @details STC polling), BK_TASK_RDS 40ms, BK_TASK_STATUS 200ms and BK_TASK_AF 1ms.
+     * @param task      BK_TASK_TUNE, BK_TASK_SEEK, BK_TASK_SCAN, BK_TASK_RDS, BK_TASK_STATUS, BK_TASK_USER or BK_TASK_AF
+     * @param ms_value  minimum time between two runs (0 = the task is disabled)
+     */
+    inline void setTaskPeriod(uint8_t task, uint16_t ms_value) { this->tasks[task].period = ms_value; };
+
+    /**
+     * @ingroup GA07
+     * @brief Sets the expected run time of a tick task
+     * @details tick does not start a task (other than the first one) that could exceed its budget.
+     * @details The defaults (1 to 2ms) fit the bit-banged bus of a 16MHz AVR. 
+     * @param task      BK_TASK_TUNE, BK_TASK_SEEK, BK_TASK_SCAN, BK_TASK_RDS, BK_TASK_STATUS, BK_TASK_USER or BK_TASK_AF
+     * @param us_value  worst case run time in microseconds
+     */
+    inline void setTaskBudget(uint8_t task, uint16_t us_value) { this->tasks[task].budget = us_value; };
+
+    uint32_t getIdleTime(uint32_t now_ms);
+
+    /**
+     * @ingroup GA07
+     * @brief Sets the low power mode
+     * @details Made for battery powered units: the MCU should sleep between the useful bus transactions.
+     * @details - Without subscribers (see subscribe), tick does not read the status nor the RDS at all.
+     * @details - With subscribers, the status task (update) runs every ms_value ms. The RDS task runs only if a RDS
+     * @details   change is subscribed. With rdsInterruptPin set, it runs when GPIO2 signals a new group (the fallback 
+     * @details   read of a lost pulse also moves to every ms_value ms).
+     * @details - getRssi, getSnr and isStereo are served from the snapshot if it is newer than ms_value.
+     * @details Tune, seek, scan and the AF following work as in the normal mode. Use getIdleTime to know how long the 
+     * @details MCU can sleep.
+     * @code
+     * rx.setLowPower(true);
+     * rx.subscribe(BK_CHANGED_RSSI | BK_CHANGED_STEREO);   // Signal meter on
+     * .
+     * void loop() {
+     *   rx.tick(millis());
+     *   sleepMs(rx.getIdleTime(millis()));                 // Your MCU sleep function (woken by the interrupts)
+     * }
+     * @endcode
+     * @param value    true = low power mode
+     * @param ms_value status period in ms (default BK_LOW_POWER_PERIOD)
+     */
+    inline void setLowPower(bool value, uint16_t ms_value = BK_LOW_POWER_PERIOD) { this->lowPower = value; this->lowPowerPeriod = (ms_value) ? ms_value : 1; };
+
+    /**
+     * @ingroup GA07
+     * @brief Subscribes to receiver changes in the low power mode
+     * @details The subscriptions are shared: a display of the signal and a RDS logger can subscribe different flags
+     * @details and each one unsubscribes its flags when it is turned off. They have no effect in the normal mode.
+     * @see setLowPower, unsubscribe, setUpdateCallback
+     * @param changes BK_CHANGED_* flags (BK_CHANGED_RDS_PS, BK_CHANGED_RDS_RT and BK_CHANGED_RDS_TIME enable the RDS task)
+     */
+    inline void subscribe(uint8_t changes) { this->subscriptions |= changes; };
+
+    /**
+     * @ingroup GA07
+     * @brief Cancels subscriptions made by subscribe
+     * @param changes BK_CHANGED_* flags
+     */
+    inline void unsubscribe(uint8_t changes) { this->subscriptions &= ~changes; };
+
+    /**
+     * @ingroup GA07
+     * @brief Sets the function run by tick in the BK_TASK_USER slot
+     * @code
+     * rx.setUserTask([]() { storage.loop(); }, 1000, 500); // Preset persistence
+     * @endcode
+     * @param task       function (NULL = no user task)
+     * @param ms_value   period in ms
+     * @param us_value   expected run time in microseconds
+     */
+    inline void setUserTask(void (*task)(), uint16_t ms_value, uint16_t us_value = 0)
+    {
+        this->userTask = task;
+        this->tasks[BK_TASK_USER].period = ms_value;
+        this->tasks[BK_TASK_USER].budget = us_value;
+    };
+};
+
+#endif // _BK108X_H
@@ -0,0 +1,211 @@
+/**
+ * @brief PU2CLR BK108X Arduino Library - Multiple receivers implementation
+ * @details See BK108XGroup.h
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#include <BK108XGroup.h>
+
+/**
+ * @defgroup GA06 Multiple Receivers
+ * @section GA06 Group
+ */
+
+/**
+ * @ingroup GA06
+ * @brief Adds a receiver to the group
+ * @details Call the receiver setup before (or after) adding it. The group does not configure the receivers.
+ * @param receiver  BK108X instance
+ * @return the receiver index or BK_GROUP_NONE if the group is full
+ */
+uint8_t BK108XGroup::add(BK108X &receiver)
+{
+    if (this->count >= BK_GROUP_MAX_RECEIVERS)
+        return BK_GROUP_NONE;
+    this->receivers[this->count] = &receiver;
+    this->lastUpdate[this->count] = 0;
+    return this->count++;
+}
+
+/**
+ * @ingroup GA06
+ * @brief Services the next receiver (round robin). Call it in your loop.
+ * @details Does one step of the work of a single receiver: scan step, seek or tune progress (STC check) or, if the 
+ * @details receiver is idle, a status and RDS refresh (see BK108X::update and setUpdatePeriod).
+ * @details So, each call takes a few bus transactions at most, whatever the number of receivers.
+ * @return index of the receiver serviced or BK_GROUP_NONE if the group is empty
+ */
+uint8_t BK108XGroup::poll()
+{
+    if (this->count == 0)
+        return BK_GROUP_NONE;
+
+    uint8_t idx = this->next;
+    uint8_t bit = 1 << idx;
+    BK108X *receiver = this->receivers[idx];
+
+    this->next = (idx + 1 < this->count) ? idx + 1 : 0;
+
+    if (receiver->isScanning())
+        receiver->pollScan();
+    else if (receiver->isSeeking())
+        receiver->pollSeek();
+    else if (receiver->isTuning())
+        receiver->pollTune();
+    else if (this->updatePeriod == 0 || (millis() - this->lastUpdate[idx]) >= this->updatePeriod)
+    {
+        this->lastUpdate[idx] = millis();
+        uint8_t changed = receiver->update();
+        if (changed && this->groupCallback != NULL)
+            this->groupCallback(idx, changed);
+    }
+
+    // The scan of this receiver finished (or was cancelled) 
+    if ((this->scanPending & bit) && !receiver->isScanning())
+    {
+        this->scanPending &= ~bit;
+        if (this->scanPending == 0)
+            this->scanDone = true;
+    }
+    return idx;
+}
+
+/**
+ * @ingroup GA06
+ * @brief Starts a tune on every receiver and returns immediately
+ * @details All the tunes are started before any STC is checked, so the receivers settle at the same time.
+ * @details poll completes the tunes.
+ * @param frequencies  one frequency per receiver (size() values)
+ */
+void BK108XGroup::startTune(const uint16_t *frequencies)
+{
+    for (uint8_t i = 0; i < this->count; i++)
+        this->receivers[i]->startTune(frequencies[i]);
+}
+
+/**
+ * @ingroup GA06
+ * @brief Checks if any receiver is tuning, seeking or scanning
+ */
+bool BK108XGroup::isBusy()
+{
+    for (uint8_t i = 0; i < this->count; i++)
+        if (this->receivers[i]->isTuning() || this->receivers[i]->isSeeking() || this->receivers[i]->isScanning())
+            return true;
+    return false;
+}
+
+/**
+ * @ingroup GA06
+ * @brief Scans the band of the first receiver, shared by all receivers
+ * @details From the minimum to the maximum frequency set by setFM or setAM on the first receiver.
+ * @see startScan(uint16_t, uint16_t)
+ */
+void BK108XGroup::startScan()
+{
+    if (this->count == 0)
+        return;
+    startScan(this->receivers[0]->getMinimumFrequency(), this->receivers[0]->getMaximumFrequency());
+}
+
+/**
+ * @ingroup GA06
+ * @brief Splits a scan among the receivers and returns immediately
+ * @details The channels from minimum_frequency to maximum_frequency are divided into size() consecutive segments,
+ * @details one per receiver, so the scan takes about 1/size() of the time of a single receiver scan.
+ * @details All the receivers must be set to the same band and space. poll does the scan steps; isScanDone returns
+ * @details true when all receivers have finished. The stations are read with getScanCount and getScanFrequency.
+ * @param minimum_frequency  first frequency
+ * @param maximum_frequency  last frequency
+ */
+void BK108XGroup::startScan(uint16_t minimum_frequency, uint16_t maximum_frequency)
+{
+    if (this->count == 0 || maximum_frequency < minimum_frequency)
+        return;
+
+    uint16_t space = this->receivers[0]->getChannelSpace();
+    uint16_t channels = (maximum_frequency - minimum_frequency) / space + 1;
+    uint16_t perReceiver = (channels + this->count - 1) / this->count;
+
+    this->scanPending = 0;
+    this->scanDone = false;
+    for (uint8_t i = 0; i < this->count && i * perReceiver < channels; i++)
+    {
+        uint16_t first = i * perReceiver;
+        uint16_t last = first + perReceiver - 1;
+        if (last >= channels)
+            last = channels - 1;
+        this->receivers[i]->startScan(minimum_frequency + first * space, minimum_frequency + last * space);
+        this->scanPending |= 1 << i;
+    }
+}
+
+/**
+ * @ingroup GA06
+ * @brief Stops the group scan (the stations found so far are kept)
+ */
+void BK108XGroup::cancelScan()
+{
+    for (uint8_t i = 0; i < this->count; i++)
+        if (this->scanPending & (1 << i))
+            this->receivers[i]->cancelScan();
+    this->scanPending = 0;
+}
+
+/**
+ * @ingroup GA06
+ * @brief Gets the number of stations found by all receivers
+ */
+uint16_t BK108XGroup::getScanCount()
+{
+    uint16_t total = 0;
+    for (uint8_t i = 0; i < this->count; i++)
+        total += this->receivers[i]->getScanCount();
+    return total;
+}
+
+/**
+ * @ingroup GA06
+ * @brief Gets a station of the aggregate scan result
+ * @details The stations of the receivers are listed in the receiver order. After a group scan, the list is sorted
+ * @details by frequency (each receiver scans the segment after the previous one).
+ * @param idx       0 to getScanCount() - 1
+ * @param receiver  optional. Returns the index of the receiver that found the station.
+ * @return the station or NULL if idx is out of range
+ */
+bk_scan_station *BK108XGroup::getScanStation(uint16_t idx, uint8_t *receiver)
+{
+    for (uint8_t i = 0; i < this->count; i++)
+    {
+        uint8_t n = this->receivers[i]->getScanCount();
+        if (idx < n)
+        {
+            if (receiver != NULL)
+                *receiver = i;
+            return this->receivers[i]->getScanStation(idx);
+        }
+        idx -= n;
+    }
+    return NULL;
+}
+
+/**
+ * @ingroup GA06
+ * @brief Gets the frequency of a station of the aggregate scan result
+ * @param idx  0 to getScanCount() - 1
+ * @return frequency (10kHz unit on FM; kHz on AM) or 0 if idx is out of range
+ */
+uint16_t BK108XGroup::getScanFrequency(uint16_t idx)
+{
+    for (uint8_t i = 0; i < this->count; i++)
+    {
+        uint8_t n = this->receivers[i]->getScanCount();
+        if (idx < n)
+            return this->receivers[i]->getScanFrequency(idx);
+        idx -= n;
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * @brief PU2CLR BK108X Arduino Library - Multiple receivers
+ * @details BK108XGroup drives some BK108X receivers from a single loop. Each call to poll services one receiver
+ * @details (round robin), so the bus time per call is bounded and one chip settles (tune, seek, scan step) while
+ * @details another one is being read. Idle receivers are refreshed with update() (one burst read of 0x09 to 0x0F,
+ * @details RDS included).
+ * @details The receivers can have their own pins, or share SCLK with one SDIO pin per receiver: a device only sees
+ * @details a START condition on its own SDIO line. All the BK108X have the same I2C address, so they cannot share
+ * @details both lines.
+ * @details Each BK108X has its own interrupt flags. Up to BK_IRQ_SLOTS receivers can use interrupt pins (one GPIO2
+ * @details line each); the others poll the status register.
+ *
+ * @code
+ * #include <BK108XGroup.h>
+ *
+ * BK108X rx1, rx2, rx3;
+ * BK108XGroup group;
+ *
+ * void setup() {
+ *   rx1.setup(SDIO1, SCLK);   // Shared SCLK
+ *   rx2.setup(SDIO2, SCLK);
+ *   rx3.setup(SDIO3, SCLK);
+ *   group.add(rx1); group.add(rx2); group.add(rx3);
+ *   for (uint8_t i = 0; i < group.size(); i++)
+ *      group.get(i).setFM(8400, 10800, 10390, 10);
+ *   group.startScan();       // Each receiver scans a third of the band
+ * }
+ *
+ * void loop() {
+ *   group.poll();
+ *   if (group.isScanDone())
+ *      for (uint8_t i = 0; i < group.getScanCount(); i++)
+ *         Serial.println(group.getScanFrequency(i));
+ * }
+ * @endcode
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#ifndef _BK108X_GROUP_H // Prevent this file from being compiled more than once
+#define _BK108X_GROUP_H
+
+#include <BK108X.h>
+
+#ifndef BK_GROUP_MAX_RECEIVERS
+#define BK_GROUP_MAX_RECEIVERS 4 //!< Maximum number of receivers of a BK108XGroup
+#endif
+
+#define BK_GROUP_NONE 0xFF //!< No receiver (see BK108XGroup::add and BK108XGroup::poll)
+
+/**
+ * @ingroup GA06
+ * @brief Round robin manager for some BK108X receivers
+ */
+class BK108XGroup
+{
+private:
+    BK108X *receivers[BK_GROUP_MAX_RECEIVERS];
+    uint32_t lastUpdate[BK_GROUP_MAX_RECEIVERS]; //!< millis() of the last update() of each receiver
+    uint8_t count = 0;
+    uint8_t next = 0;                 //!< Next receiver to be serviced by poll
+    uint8_t scanPending = 0;          //!< One bit per receiver still scanning
+    bool scanDone = false;            //!< The last group scan has finished (see isScanDone)
+    uint16_t updatePeriod = 0;        //!< Minimum time (ms) between two update() of an idle receiver
+    void (*groupCallback)(uint8_t receiver, uint8_t changed) = NULL;
+
+public:
+    uint8_t add(BK108X &receiver);
+    uint8_t poll();
+    void startTune(const uint16_t *frequencies);
+    bool isBusy();
+    void startScan();
+    void startScan(uint16_t minimum_frequency, uint16_t maximum_frequency);
+    void cancelScan();
+    uint16_t getScanCount();
+    uint16_t getScanFrequency(uint16_t idx);
+    bk_scan_station *getScanStation(uint16_t idx, uint8_t *receiver = NULL);
+
+    /**
+     * @ingroup GA06
+     * @brief Gets the number of receivers of the group
+     */
+    inline uint8_t size() { return this->count; };
+
+    /**
+     * @ingroup GA06
+     * @brief Gets a receiver of the group
+     * @param idx  0 to size() - 1 (order of add)
+     */
+    inline BK108X &get(uint8_t idx) { return *this->receivers[idx]; };
+
+    /**
+     * @ingroup GA06
+     * @brief Sets the minimum time between two status refreshes of an idle receiver
+     * @details 0 (default) refreshes an idle receiver every time it is serviced by poll.
+     * @param ms_value  time in ms
+     */
+    inline void setUpdatePeriod(uint16_t ms_value) { this->updatePeriod = ms_value; };
+
+    /**
+     * @ingroup GA06
+     * @brief Sets the function called when the status of a receiver changes
+     * @details changed has the BK_CHANGED_* flags returned by BK108X::update.
+     * @param callback  void function(uint8_t receiver, uint8_t changed)
+     */
+    inline void setGroupCallback(void (*callback)(uint8_t receiver, uint8_t changed)) { this->groupCallback = callback; };
+
+    /**
+     * @ingroup GA06
+     * @brief Checks if a group scan is in progress
+     */
+    inline bool isScanning() { return this->scanPending != 0; };
+
+    /**
+     * @ingroup GA06
+     * @brief Returns true once, when the group scan finishes
+     */
+    inline bool isScanDone()
+    {
+        bool done = this->scanDone;
+        this->scanDone = false;
+        return done;
+    };
+};
+
+#endif // _BK108X_GROUP_H
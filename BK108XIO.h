@@ -0,0 +1,53 @@
+/**
+ * @brief PU2CLR BK108X Arduino Library - Direct port I/O
+ * @details Macros used by the bit-banged I2C bus (BK108X and BK108XPinBus) to toggle the SDIO and SCLK pins
+ * @details through the port registers. The pins are resolved to bk_io_pin (port/mask pairs) by bkResolvePin.
+ * @details Only available if BK108X_FAST_IO is defined (see BK108X.h).
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#ifndef _BK108X_IO_H // Prevent this file from being compiled more than once
+#define _BK108X_IO_H
+
+#include <BK108X.h>
+
+#if defined(BK108X_FAST_IO)
+#if defined(ARDUINO_ARCH_ESP32)
+#include "soc/gpio_reg.h"
+#include "driver/gpio.h"
+#define BK_IO_HIGH(p) REG_WRITE(GPIO_OUT_W1TS_REG, (p).mask)
+#define BK_IO_LOW(p) REG_WRITE(GPIO_OUT_W1TC_REG, (p).mask)
+#define BK_IO_OUTPUT(p) REG_WRITE(GPIO_ENABLE_W1TS_REG, (p).mask)
+#define BK_IO_INPUT(p) REG_WRITE(GPIO_ENABLE_W1TC_REG, (p).mask)
+#define BK_IO_READ(p) ((REG_READ(GPIO_IN_REG) & (p).mask) != 0)
+#elif defined(ARDUINO_ARCH_RP2040)
+#include "hardware/structs/sio.h"
+#define BK_IO_HIGH(p) (sio_hw->gpio_set = (p).mask)
+#define BK_IO_LOW(p) (sio_hw->gpio_clr = (p).mask)
+#define BK_IO_OUTPUT(p) (sio_hw->gpio_oe_set = (p).mask)
+#define BK_IO_INPUT(p) (sio_hw->gpio_oe_clr = (p).mask)
+#define BK_IO_READ(p) ((sio_hw->gpio_in & (p).mask) != 0)
+#elif defined(ARDUINO_ARCH_STM32)
+#define BK_IO_HIGH(p) ((p).port->BSRR = (p).mask)
+#define BK_IO_LOW(p) ((p).port->BSRR = (p).mask << 16)
+#define BK_IO_OUTPUT(p) ((p).port->MODER = ((p).port->MODER & ~(3UL << (p).shift)) | (1UL << (p).shift))
+#define BK_IO_INPUT(p) ((p).port->MODER &= ~(3UL << (p).shift))
+#define BK_IO_READ(p) (((p).port->IDR & (p).mask) != 0)
+#else // AVR
+// The mask is not a constant, so the compiler cannot use sbi/cbi: the read-modify-write of the port is done with the
+// interrupts disabled (like digitalWrite), so an ISR writing another pin of the same port does not lose its write.
+#define BK_IO_ATOMIC(op) do { uint8_t sreg = SREG; cli(); op; SREG = sreg; } while (0)
+#define BK_IO_HIGH(p) BK_IO_ATOMIC(*(p).out |= (p).mask)
+#define BK_IO_LOW(p) BK_IO_ATOMIC(*(p).out &= ~(p).mask)
+#define BK_IO_OUTPUT(p) BK_IO_ATOMIC(*(p).dir |= (p).mask)
+#define BK_IO_INPUT(p) BK_IO_ATOMIC(*(p).dir &= ~(p).mask)
+#define BK_IO_READ(p) ((*(p).in & (p).mask) != 0)
+#endif
+
+bool bkResolvePin(int pin, bk_io_pin &io, bool sdio);
+#endif
+
+#endif // _BK108X_IO_H
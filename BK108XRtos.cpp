@@ -0,0 +1,352 @@
+/**
+ * @brief PU2CLR BK108X Arduino Library - FreeRTOS radio task implementation
+ * @details See BK108XRtos.h
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#include <BK108XRtos.h>
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(BK108X_FREERTOS)
+
+// Command types
+#define BK_RTOS_TUNE 1        // value = frequency
+#define BK_RTOS_STEP 2        // value = steps (negative = down)
+#define BK_RTOS_SEEK 3        // param = (seek_mode << 1) | direction
+#define BK_RTOS_CANCEL_SEEK 4
+#define BK_RTOS_VOLUME 5      // value = volume
+#define BK_RTOS_VOLUME_STEP 6 // value = steps (negative = down)
+#define BK_RTOS_MUTE 7        // param = mute
+#define BK_RTOS_RDS 8         // param = on/off
+#define BK_RTOS_CALL 9        // function and arg
+
+/**
+ * @defgroup GA08 FreeRTOS Radio Task
+ * @section GA08 RTOS
+ */
+
+/**
+ * @ingroup GA08
+ * @brief Starts the radio task
+ * @details The receiver must be ready (setup, setFM or setAM...). From this call on, only the radio task calls it.
+ * @details The BK108X callbacks (setTuneCallback, setSeekCallback, setUpdateCallback...) run in the radio task.
+ * @param stackSize    radio task stack size (bytes on ESP32; words on other ports)
+ * @param priority     radio task priority
+ * @param queueLength  command queue length
+ * @param core         ESP32 core of the radio task (-1 = any core). Ignored by other ports.
+ * @return false if the queue or the task could not be created
+ */
+bool BK108XRtos::begin(uint32_t stackSize, UBaseType_t priority, uint8_t queueLength, int core)
+{
+    if (this->task != NULL)
+        return true;
+    if (this->queue == NULL)
+        this->queue = xQueueCreate(queueLength, sizeof(bk_rtos_command));
+    if (this->queue == NULL)
+        return false;
+
+    publish(); // The first snapshot is valid before the task runs
+#if defined(ARDUINO_ARCH_ESP32)
+    if (core >= 0)
+        xTaskCreatePinnedToCore(taskEntry, "BK108X", stackSize, this, priority, &this->task, core);
+    else
+#endif
+        xTaskCreate(taskEntry, "BK108X", stackSize, this, priority, &this->task);
+    return this->task != NULL;
+}
+
+void BK108XRtos::taskEntry(void *object)
+{
+    ((BK108XRtos *)object)->run();
+}
+
+/**
+ * @ingroup GA08
+ * @brief Radio task loop
+ * @details Waits for a command up to BK_RTOS_PERIOD ms, merges all the commands waiting in the queue, applies them,
+ * @details runs the receiver background work (BK108X::tick) and publishes the status snapshot.
+ */
+void BK108XRtos::run()
+{
+    TickType_t wait = pdMS_TO_TICKS(BK_RTOS_PERIOD);
+    bk_rtos_command command;
+
+    if (wait == 0)
+        wait = 1; // Always yields to the other tasks
+    for (;;)
+    {
+        if (xQueueReceive(this->queue, &command, wait) == pdTRUE)
+        {
+            do
+                merge(command);
+            while (xQueueReceive(this->queue, &command, 0) == pdTRUE);
+            apply();
+        }
+        this->rx->tick(millis());
+        publish();
+    }
+}
+
+/**
+ * @ingroup GA08
+ * @brief Merges a command into the pending actions
+ * @details A tune replaces the pending tune, step or seek; steps are added to the pending tune or step; a seek
+ * @details replaces the pending tune or step. The same for the volume. Mute and RDS keep the last value.
+ * @details A call command is run at once, after the actions merged before it.
+ */
+void BK108XRtos::merge(const bk_rtos_command &command)
+{
+    switch (command.type)
+    {
+    case BK_RTOS_TUNE:
+        this->tuneAction = BK_RTOS_TUNE;
+        this->tuneTarget = command.value;
+        this->tuneSteps = 0;
+        break;
+    case BK_RTOS_STEP:
+        if (this->tuneAction != BK_RTOS_TUNE && this->tuneAction != BK_RTOS_STEP)
+        {
+            this->tuneAction = BK_RTOS_STEP;
+            this->tuneSteps = 0;
+        }
+        this->tuneSteps += command.value;
+        break;
+    case BK_RTOS_SEEK:
+    case BK_RTOS_CANCEL_SEEK:
+        this->tuneAction = command.type;
+        this->seekParam = command.param;
+        break;
+    case BK_RTOS_VOLUME:
+        this->volumeAction = BK_RTOS_VOLUME;
+        this->volumeValue = command.value;
+        break;
+    case BK_RTOS_VOLUME_STEP:
+        if (this->volumeAction == 0)
+        {
+            this->volumeAction = BK_RTOS_VOLUME_STEP;
+            this->volumeValue = 0;
+        }
+        this->volumeValue += command.value;
+        break;
+    case BK_RTOS_MUTE:
+        this->muteValue = command.param;
+        break;
+    case BK_RTOS_RDS:
+        this->rdsValue = command.param;
+        break;
+    case BK_RTOS_CALL:
+        apply();
+        command.function(*this->rx, command.arg);
+        break;
+    }
+}
+
+/**
+ * @ingroup GA08
+ * @brief Applies the pending actions to the receiver
+ * @details The tune is started and not waited for (completed by BK108X::tick). A seek or scan in progress is
+ * @details canceled by a new tune or seek.
+ */
+void BK108XRtos::apply()
+{
+    BK108X &rx = *this->rx;
+
+    if (this->tuneAction == BK_RTOS_TUNE || this->tuneAction == BK_RTOS_STEP)
+    {
+        uint16_t frequency = (this->tuneAction == BK_RTOS_TUNE) ? this->tuneTarget : rx.getFrequency();
+        uint16_t step = rx.getStep();
+        // Same wrap around of setFrequencyUp and setFrequencyDown
+        for (; this->tuneSteps > 0; this->tuneSteps--)
+        {
+            frequency += step;
+            if (frequency > rx.getMaximumFrequency())
+                frequency = rx.getMinimumFrequency();
+        }
+        for (; this->tuneSteps < 0; this->tuneSteps++)
+        {
+            frequency -= step;
+            if (frequency < rx.getMinimumFrequency())
+                frequency = rx.getMaximumFrequency();
+        }
+        rx.cancelScan();
+        rx.cancelSeek();
+        rx.startTune(frequency);
+    }
+    else if (this->tuneAction == BK_RTOS_SEEK)
+    {
+        rx.cancelScan();
+        rx.startSeek(this->seekParam >> 1, this->seekParam & 1);
+    }
+    else if (this->tuneAction == BK_RTOS_CANCEL_SEEK)
+        rx.cancelSeek();
+    this->tuneAction = 0;
+
+    if (this->volumeAction == BK_RTOS_VOLUME)
+        rx.setVolume(this->volumeValue);
+    else if (this->volumeAction == BK_RTOS_VOLUME_STEP)
+    {
+        int16_t volume = rx.getVolume() + this->volumeValue;
+        rx.setVolume((volume < 0) ? 0 : (volume > 31) ? 31 : volume);
+    }
+    this->volumeAction = 0;
+
+    if (this->muteValue >= 0)
+        rx.setAudioMute(this->muteValue);
+    this->muteValue = -1;
+
+    if (this->rdsValue >= 0)
+        rx.setRds(this->rdsValue);
+    this->rdsValue = -1;
+}
+
+/**
+ * @ingroup GA08
+ * @brief Writes a new status snapshot (radio task only)
+ * @details The snapshot is written in the buffer not read by getStatus and then published.
+ */
+void BK108XRtos::publish()
+{
+    BK108X &rx = *this->rx;
+    uint32_t n = this->published + 1;
+    bk_rtos_status &status = this->snapshot[n & 1];
+    const char *text;
+
+    this->writing = n;
+    __sync_synchronize();
+
+    status.sequence = n;
+    status.frequency = rx.getFrequency();
+    status.volume = rx.getVolume();
+    status.rssi = rx.getUpdatedRssi();
+    status.snr = rx.getUpdatedSnr();
+    status.stereo = rx.isUpdatedStereo();
+    status.tuning = rx.isTuning();
+    status.seeking = rx.isSeeking();
+    status.scanning = rx.isScanning();
+    status.rdsSync = rx.getRdsSync();
+    status.mode = rx.getCurrentMode();
+    status.busFailures = rx.getBusErrors().failures;
+    text = rx.getRdsText0A();
+    strncpy(status.ps, (text != NULL) ? text : "", sizeof(status.ps) - 1);
+    status.ps[sizeof(status.ps) - 1] = '\0';
+    text = rx.getRdsText2A();
+    strncpy(status.rt, (text != NULL) ? text : "", sizeof(status.rt) - 1);
+    status.rt[sizeof(status.rt) - 1] = '\0';
+
+    __sync_synchronize();
+    this->published = n;
+}
+
+/**
+ * @ingroup GA08
+ * @brief Gets the last status snapshot
+ * @details Can be called by any task. It takes no lock and never waits for the radio task: the copy is repeated
+ * @details only if the radio task rewrote the buffer during the copy (two snapshots in the meantime).
+ * @param status  receives the snapshot
+ * @return false if a consistent copy could not be done (the radio task is publishing too fast)
+ */
+bool BK108XRtos::getStatus(bk_rtos_status &status)
+{
+    for (uint8_t attempt = 0; attempt < 4; attempt++)
+    {
+        uint32_t n = this->published;
+        __sync_synchronize();
+        memcpy(&status, &this->snapshot[n & 1], sizeof(status));
+        __sync_synchronize();
+        if (this->writing - n < 2) // The buffer of snapshot n is only rewritten by snapshot n + 2
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @ingroup GA08
+ * @brief Sends a command to the radio task
+ * @return false if the queue is full (or begin was not called)
+ */
+bool BK108XRtos::send(uint8_t type, int16_t value, uint8_t param)
+{
+    bk_rtos_command command = {type, param, value, NULL, NULL};
+    return this->queue != NULL && xQueueSend(this->queue, &command, 0) == pdTRUE;
+}
+
+/**
+ * @ingroup GA08
+ * @brief Tunes a frequency (see BK108X::startTune)
+ */
+bool BK108XRtos::setFrequency(uint16_t frequency) { return send(BK_RTOS_TUNE, frequency); }
+
+/**
+ * @ingroup GA08
+ * @brief Goes some steps up (see BK108X::setFrequencyUp). Pending steps are added up into a single tune.
+ */
+bool BK108XRtos::frequencyUp(int16_t steps) { return send(BK_RTOS_STEP, steps); }
+
+/**
+ * @ingroup GA08
+ * @brief Goes some steps down (see BK108X::setFrequencyDown). Pending steps are added up into a single tune.
+ */
+bool BK108XRtos::frequencyDown(int16_t steps) { return send(BK_RTOS_STEP, -steps); }
+
+/**
+ * @ingroup GA08
+ * @brief Starts a seek (see BK108X::startSeek)
+ */
+bool BK108XRtos::seek(uint8_t seek_mode, uint8_t direction) { return send(BK_RTOS_SEEK, 0, (seek_mode << 1) | (direction & 1)); }
+
+/**
+ * @ingroup GA08
+ * @brief Stops the seek in progress (see BK108X::cancelSeek)
+ */
+bool BK108XRtos::cancelSeek() { return send(BK_RTOS_CANCEL_SEEK); }
+
+/**
+ * @ingroup GA08
+ * @brief Sets the volume (0 to 31)
+ */
+bool BK108XRtos::setVolume(uint8_t value) { return send(BK_RTOS_VOLUME, value); }
+
+/**
+ * @ingroup GA08
+ * @brief Increments the volume. Pending steps are added up.
+ */
+bool BK108XRtos::volumeUp() { return send(BK_RTOS_VOLUME_STEP, 1); }
+
+/**
+ * @ingroup GA08
+ * @brief Decrements the volume. Pending steps are added up.
+ */
+bool BK108XRtos::volumeDown() { return send(BK_RTOS_VOLUME_STEP, -1); }
+
+/**
+ * @ingroup GA08
+ * @brief Mutes or unmutes the audio (see BK108X::setAudioMute)
+ */
+bool BK108XRtos::setAudioMute(bool value) { return send(BK_RTOS_MUTE, 0, value); }
+
+/**
+ * @ingroup GA08
+ * @brief Enables or disables RDS (see BK108X::setRds)
+ */
+bool BK108XRtos::setRds(bool value) { return send(BK_RTOS_RDS, 0, value); }
+
+/**
+ * @ingroup GA08
+ * @brief Runs a function in the radio task
+ * @details For the receiver functions without a command. The commands sent before are applied first.
+ * @details The function must not block (use the non-blocking functions of BK108X).
+ * @code
+ * radio.call([](BK108X &rx, void *) { rx.setBand(2); });
+ * @endcode
+ * @param function  function called with the receiver and arg
+ * @param arg       argument of the function
+ */
+bool BK108XRtos::call(void (*function)(BK108X &rx, void *arg), void *arg)
+{
+    bk_rtos_command command = {BK_RTOS_CALL, 0, 0, function, arg};
+    return this->queue != NULL && xQueueSend(this->queue, &command, 0) == pdTRUE;
+}
+
+#endif // ARDUINO_ARCH_ESP32 || BK108X_FREERTOS
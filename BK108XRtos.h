@@ -0,0 +1,169 @@
+/**
+ * @brief PU2CLR BK108X Arduino Library - FreeRTOS radio task
+ * @details BK108XRtos gives the BK108X bus to a single radio task. The other tasks (UI, network API, RDS logger...)
+ * @details do not call the receiver: they send commands through a queue and read the status from a snapshot.
+ * @details - Commands: tune, frequency up/down, seek, volume, mute, RDS and custom functions (see call). They never
+ * @details   block: false is returned if the queue is full.
+ * @details - Coalescing: the radio task drains the queue before acting. Superseded commands are merged: the last
+ * @details   tune wins, repeated frequencyUp/frequencyDown (and volumeUp/volumeDown) are added up, a tune discards a
+ * @details   pending seek and so on. So, a fast encoder costs one tune, not one per detent.
+ * @details - Status: the radio task publishes a bk_rtos_status snapshot after each loop in a double buffer.
+ * @details   getStatus copies the last complete snapshot without locks and never blocks the caller.
+ * @details The radio task runs BK108X::tick between the commands (tune completion, seek progress, RDS, status).
+ * @details Available on ESP32 (Arduino core). On other FreeRTOS ports, build with BK108X_FREERTOS defined (the
+ * @details FreeRTOS.h, task.h and queue.h headers must be in the include path).
+ *
+ * @code
+ * #include <BK108XRtos.h>
+ *
+ * BK108X rx;
+ * BK108XRtos radio(rx);
+ *
+ * void setup() {
+ *   rx.setup(SDIO_PIN, SCLK_PIN);
+ *   rx.setFM(8400, 10800, 10390, 10);
+ *   rx.setRds(true);
+ *   radio.begin();          // From here, only the radio task calls rx
+ * }
+ *
+ * void uiTask(void *) {     // Any task
+ *   bk_rtos_status status;
+ *   for (;;) {
+ *     if (encoderUp()) radio.frequencyUp();
+ *     radio.getStatus(status);
+ *     showFrequency(status.frequency);
+ *     vTaskDelay(pdMS_TO_TICKS(20));
+ *   }
+ * }
+ * @endcode
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#ifndef _BK108X_RTOS_H // Prevent this file from being compiled more than once
+#define _BK108X_RTOS_H
+
+#include <BK108X.h>
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(BK108X_FREERTOS)
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#else
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#endif
+
+#define BK_RTOS_QUEUE_LENGTH 16 //!< Default command queue length (see BK108XRtos::begin)
+#define BK_RTOS_STACK_SIZE 4096 //!< Default radio task stack size (see BK108XRtos::begin)
+#define BK_RTOS_PRIORITY 2      //!< Default radio task priority (see BK108XRtos::begin)
+#define BK_RTOS_PERIOD 5        //!< Maximum time (ms) the radio task waits for a command between two ticks
+
+/**
+ * @ingroup GA01
+ * @brief Status snapshot published by the radio task
+ * @see BK108XRtos::getStatus
+ */
+typedef struct
+{
+    uint32_t sequence;     //!< Incremented at each snapshot
+    uint16_t frequency;    //!< Current frequency (target of the tune in progress)
+    uint8_t volume;        //!< Volume
+    uint8_t rssi;          //!< RSSI of the last status refresh (dBuV)
+    uint8_t snr;           //!< SNR of the last status refresh (dB)
+    uint8_t stereo : 1;    //!< Stereo indicator
+    uint8_t tuning : 1;    //!< A tune is in progress
+    uint8_t seeking : 1;   //!< A seek is in progress
+    uint8_t scanning : 1;  //!< A scan is in progress
+    uint8_t rdsSync : 1;   //!< RDS groups are being received
+    uint8_t : 3;
+    uint8_t mode;          //!< FM or AM
+    uint16_t busFailures;  //!< Bus transactions given up (see BK108X::getBusErrors)
+    char ps[9];            //!< RDS Program Service name ("" if not received)
+    char rt[65];           //!< RDS Radio Text 2A ("" if not received)
+} bk_rtos_status;
+
+/**
+ * @ingroup GA01
+ * @brief Command sent to the radio task
+ */
+typedef struct
+{
+    uint8_t type;                         //!< BK108XRtos command (see BK108XRtos.cpp)
+    uint8_t param;                        //!< Command parameter (seek mode, mute...)
+    int16_t value;                        //!< Command value (frequency, steps, volume...)
+    void (*function)(BK108X &, void *);   //!< Function of a call command
+    void *arg;                            //!< Argument of a call command
+} bk_rtos_command;
+
+/**
+ * @ingroup GA08
+ * @brief Radio task, command queue and status snapshot for a BK108X
+ */
+class BK108XRtos
+{
+private:
+    BK108X *rx;
+    QueueHandle_t queue = NULL;
+    TaskHandle_t task = NULL;
+
+    // Commands merged by the radio task since the last apply
+    uint8_t tuneAction = 0;    //!< Pending tune: none, tune, step or seek
+    uint16_t tuneTarget = 0;   //!< Frequency of a pending tune
+    int16_t tuneSteps = 0;     //!< Steps of a pending step
+    uint8_t seekParam = 0;     //!< Direction and mode of a pending seek
+    uint8_t volumeAction = 0;  //!< Pending volume: none, set or step
+    int16_t volumeValue = 0;   //!< Volume or steps
+    int8_t muteValue = -1;     //!< Pending mute (-1 = none)
+    int8_t rdsValue = -1;      //!< Pending RDS on/off (-1 = none)
+
+    // Double-buffered snapshot (see publish and getStatus)
+    bk_rtos_status snapshot[2];
+    volatile uint32_t published = 0; //!< Number of snapshots published; snapshot[published & 1] is the last one
+    volatile uint32_t writing = 0;   //!< Number of the snapshot being written
+
+    static void taskEntry(void *object);
+    void run();
+    void merge(const bk_rtos_command &command);
+    void apply();
+    void publish();
+    bool send(uint8_t type, int16_t value = 0, uint8_t param = 0);
+
+public:
+    /**
+     * @ingroup GA08
+     * @param rx  receiver already set up (setup, setFM...). After begin, only the radio task must call it.
+     */
+    BK108XRtos(BK108X &rx) : rx(&rx) {};
+
+    bool begin(uint32_t stackSize = BK_RTOS_STACK_SIZE, UBaseType_t priority = BK_RTOS_PRIORITY, uint8_t queueLength = BK_RTOS_QUEUE_LENGTH, int core = -1);
+
+    bool setFrequency(uint16_t frequency);
+    bool frequencyUp(int16_t steps = 1);
+    bool frequencyDown(int16_t steps = 1);
+    bool seek(uint8_t seek_mode, uint8_t direction);
+    bool cancelSeek();
+    bool setVolume(uint8_t value);
+    bool volumeUp();
+    bool volumeDown();
+    bool setAudioMute(bool value);
+    bool setRds(bool value);
+    bool call(void (*function)(BK108X &rx, void *arg), void *arg = NULL);
+
+    bool getStatus(bk_rtos_status &status);
+
+    /**
+     * @ingroup GA08
+     * @brief Gets the radio task handle (NULL before begin)
+     */
+    inline TaskHandle_t getTask() { return this->task; };
+};
+
+#endif // ARDUINO_ARCH_ESP32 || BK108X_FREERTOS
+
+#endif // _BK108X_RTOS_H
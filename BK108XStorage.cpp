@@ -0,0 +1,218 @@
+/**
+ * @brief PU2CLR BK108X Arduino Library - Persistent storage implementation
+ * @details See BK108XStorage.h
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#include <BK108XStorage.h>
+
+/**
+ * @defgroup GA05 Persistent Storage
+ * @section GA05 Storage
+ */
+
+/**
+ * @ingroup GA05
+ * @brief Creates the record storage
+ * @details The number of slots is the size of the backend storage area divided by (record size + 4).
+ * @details The more slots, the fewer writes per slot.
+ * @param backend     storage backend (see BK108XEepromBackend and BK108XPreferencesBackend)
+ * @param recordSize  size of the record (for example, sizeof(bk_storage_data))
+ */
+BK108XStorage::BK108XStorage(BK108XStorageBackend &backend, uint16_t recordSize)
+{
+    this->backend = &backend;
+    this->recordSize = recordSize;
+    uint16_t slots = backend.size() / (recordSize + 4);
+    this->slots = (slots > 255) ? 255 : slots;
+}
+
+/**
+ * @ingroup GA05
+ * @brief CRC-16 (CCITT) update
+ * @param crc     CRC of the previous bytes
+ * @param data    next bytes
+ * @param length  number of bytes
+ */
+uint16_t BK108XStorage::crc16(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    return crc;
+}
+
+/**
+ * @ingroup GA05
+ * @brief CRC of a record and its sequence number
+ * @details The seed depends on the record size. So, a record written with another record layout is not valid.
+ */
+uint16_t BK108XStorage::recordCrc(uint16_t sequence, const uint8_t *record)
+{
+    uint8_t seq[2] = {(uint8_t)(sequence & 0xFF), (uint8_t)(sequence >> 8)};
+    return crc16(crc16(0xFFFF ^ this->recordSize, seq, 2), record, this->recordSize);
+}
+
+/**
+ * @ingroup GA05
+ * @brief Checks the CRC of a slot
+ * @details The record is read BK_STORAGE_CHUNK bytes at a time. So, no record sized buffer is needed.
+ * @param slot      slot index
+ * @param sequence  returns the sequence number of the slot
+ * @return true if the slot has a valid record
+ */
+bool BK108XStorage::checkSlot(uint8_t slot, uint16_t &sequence)
+{
+    uint8_t buffer[BK_STORAGE_CHUNK];
+    uint16_t address = slotAddress(slot);
+
+    this->backend->read(address, buffer, 4);
+    sequence = buffer[0] | (buffer[1] << 8);
+    uint16_t stored = buffer[2] | (buffer[3] << 8);
+    uint16_t crc = crc16(0xFFFF ^ this->recordSize, buffer, 2);
+    for (uint16_t i = 0; i < this->recordSize; i += BK_STORAGE_CHUNK)
+    {
+        uint16_t n = (this->recordSize - i < BK_STORAGE_CHUNK) ? this->recordSize - i : BK_STORAGE_CHUNK;
+        this->backend->read(address + 4 + i, buffer, n);
+        crc = crc16(crc, buffer, n);
+    }
+    return crc == stored;
+}
+
+/**
+ * @ingroup GA05
+ * @brief Compares a record with the record stored in a slot
+ * @param slot    slot index
+ * @param record  buffer with recordSize bytes
+ * @return true if all bytes are equal
+ */
+bool BK108XStorage::isSlotEqual(uint8_t slot, const uint8_t *record)
+{
+    uint8_t buffer[BK_STORAGE_CHUNK];
+    uint16_t address = slotAddress(slot) + 4;
+
+    for (uint16_t i = 0; i < this->recordSize; i += BK_STORAGE_CHUNK)
+    {
+        uint16_t n = (this->recordSize - i < BK_STORAGE_CHUNK) ? this->recordSize - i : BK_STORAGE_CHUNK;
+        this->backend->read(address + i, buffer, n);
+        if (memcmp(buffer, record + i, n) != 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @ingroup GA05
+ * @brief Initializes the backend and loads the most recent valid record
+ * @details Call it in setup (not from a global constructor). Scans all slots. Sequence numbers are compared with 
+ * @details wrap around (16 bits).
+ * @param record  buffer with recordSize bytes. It is not changed if no valid record is found.
+ * @return true if a valid record was found (false also if the backend could not be initialized)
+ */
+bool BK108XStorage::begin(void *record)
+{
+    uint16_t seq;
+
+    this->hasRecord = false;
+    this->pending = NULL;
+    this->ready = this->backend->begin();
+    if (!this->ready)
+        return false;
+    for (uint8_t slot = 0; slot < this->slots; slot++)
+    {
+        if (!checkSlot(slot, seq))
+            continue;
+        if (!this->hasRecord || (int16_t)(seq - this->sequence) > 0)
+        {
+            this->hasRecord = true;
+            this->sequence = seq;
+            this->currentSlot = slot;
+        }
+    }
+    if (this->hasRecord)
+        this->backend->read(slotAddress(this->currentSlot) + 4, (uint8_t *)record, this->recordSize);
+    return this->hasRecord;
+}
+
+/**
+ * @ingroup GA05
+ * @brief Registers a change to be committed later
+ * @details Does not write anything. The record is written by loop after the commit delay without new updates.
+ * @details The record buffer must be kept (it is read only when the commit happens).
+ * @param record  buffer with recordSize bytes
+ */
+void BK108XStorage::update(const void *record)
+{
+    this->pending = record;
+    this->changeTime = millis();
+}
+
+/**
+ * @ingroup GA05
+ * @brief Runs the deferred commit. Call it in your loop.
+ * @return true if a record was written
+ */
+bool BK108XStorage::loop()
+{
+    if (this->pending == NULL || (millis() - this->changeTime) < this->commitDelay)
+        return false;
+    return flush();
+}
+
+/**
+ * @ingroup GA05
+ * @brief Writes the pending change right away (for example, before powering down)
+ * @return true if a record was written
+ */
+bool BK108XStorage::flush()
+{
+    if (this->pending == NULL)
+        return false;
+    const void *record = this->pending;
+    this->pending = NULL;
+    return commit(record);
+}
+
+/**
+ * @ingroup GA05
+ * @brief Writes a record to the next slot
+ * @details Nothing is written if the record is equal to the last one written or loaded (compared byte by byte with 
+ * @details the stored slot). Nothing is written before begin.
+ * @param record  buffer with recordSize bytes
+ * @return true if the record was written
+ */
+bool BK108XStorage::commit(const void *record)
+{
+    uint8_t header[4];
+
+    if (!this->ready || this->slots == 0)
+        return false;
+
+    if (this->hasRecord && isSlotEqual(this->currentSlot, (const uint8_t *)record))
+        return false;
+
+    uint8_t slot = (this->hasRecord) ? (this->currentSlot + 1) % this->slots : 0;
+    uint16_t seq = this->sequence + 1;
+    uint16_t crc = recordCrc(seq, (const uint8_t *)record);
+
+    header[0] = seq & 0xFF;
+    header[1] = seq >> 8;
+    header[2] = crc & 0xFF;
+    header[3] = crc >> 8;
+    // The record is written before the header. So, an interrupted write leaves an invalid slot.
+    this->backend->write(slotAddress(slot) + 4, (const uint8_t *)record, this->recordSize);
+    this->backend->write(slotAddress(slot), header, 4);
+    this->backend->commit();
+
+    this->currentSlot = slot;
+    this->sequence = seq;
+    this->hasRecord = true;
+    this->commits++;
+    return true;
+}
@@ -0,0 +1,285 @@
+/**
+ * @brief PU2CLR BK108X Arduino Library - Persistent storage
+ * @details Stores presets, the last band, frequency and volume and the register image (see BK108X::saveState)
+ * @details in EEPROM or flash. The data is written as CRC checked records with a sequence number. Each commit uses
+ * @details the next record slot of the storage area (wear leveling) and the most recent valid record is loaded at boot.
+ * @details Commits are deferred: changes are kept in RAM and written only after a quiet time (see BK108XStorage::loop).
+ * @details So, turning the encoder quickly does not cause a write per step.
+ *
+ * @code
+ * #include <BK108X.h>
+ * #include <BK108XStorage.h>
+ *
+ * BK108X rx;
+ * BK108XEepromBackend backend(0, 512); // EEPROM address 0 to 511
+ * BK108XStorage storage(backend, sizeof(bk_storage_data));
+ * bk_storage_data data;
+ *
+ * void setup() {
+ *   if (storage.begin(&data))
+ *      rx.setup(SDA_PIN, SCLK_PIN, data.state);   // Warm resume: last band, frequency and volume
+ *   else {
+ *      rx.setup(SDA_PIN, SCLK_PIN);
+ *      rx.setFM(8400, 10800, 10390, 10);
+ *   }
+ * }
+ *
+ * void loop() {
+ *   if (encoderCount != 0) {
+ *      rx.setFrequencyUp();
+ *      rx.saveState(data.state);
+ *      storage.update(&data);   // no write here
+ *   }
+ *   storage.loop();             // writes after BK_STORAGE_COMMIT_DELAY ms without changes
+ * }
+ * @endcode
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#ifndef _BK108X_STORAGE_H // Prevent this file from being compiled more than once
+#define _BK108X_STORAGE_H
+
+#include <BK108X.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <Preferences.h>
+#endif
+#if defined(__AVR__) || defined(ESP8266) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_STM32)
+#include <EEPROM.h>
+#if defined(ESP8266) || defined(ARDUINO_ARCH_RP2040)
+#define BK_STORAGE_EEPROM_COMMIT // EEPROM emulated in flash: needs EEPROM.begin and EEPROM.commit
+#endif
+#endif
+
+#define BK_STORAGE_COMMIT_DELAY 5000 //!< Default quiet time (ms) before a deferred commit (see BK108XStorage::setCommitDelay)
+
+#ifndef BK_STORAGE_CHUNK
+#define BK_STORAGE_CHUNK 16 //!< Bytes read at a time to check a record slot (stack buffer of BK108XStorage)
+#endif
+
+#ifndef BK_STORAGE_MAX_PRESETS
+#define BK_STORAGE_MAX_PRESETS 10 //!< Number of presets in bk_storage_data
+#endif
+
+/**
+ * @ingroup GA05
+ * @brief Preset (memory)
+ */
+typedef struct
+{
+    uint16_t frequency; //!< Frequency (0 = empty preset)
+    uint8_t band;       //!< Application band index (for example, the index of the band table of the sketch)
+} bk_preset;
+
+/**
+ * @ingroup GA05
+ * @brief Default data stored by BK108XStorage
+ * @details You can store your own struct instead. Just give its size to the BK108XStorage constructor.
+ */
+typedef struct
+{
+    bk_state state;                            //!< Register image, band, space, frequency and volume (see BK108X::saveState)
+    uint8_t band;                              //!< Last application band index
+    bk_preset preset[BK_STORAGE_MAX_PRESETS];  //!< Presets
+} bk_storage_data;
+
+/**
+ * @ingroup GA05
+ * @brief Storage backend interface
+ * @details Implement it to use another kind of memory (I2C EEPROM, FRAM, SD card...).
+ * @details Do the hardware initialization in begin, not in the constructor: a global backend is constructed before
+ * @details the core is initialized (and maybe before the core objects it uses, like EEPROM).
+ */
+class BK108XStorageBackend
+{
+public:
+    /**
+     * @brief Initializes the memory. Called by BK108XStorage::begin
+     * @return false if the memory cannot be used
+     */
+    virtual bool begin() { return true; };
+
+    /**
+     * @brief Size of the storage area in bytes
+     */
+    virtual uint16_t size() = 0;
+
+    /**
+     * @brief Reads length bytes from address (relative to the beginning of the storage area)
+     */
+    virtual void read(uint16_t address, uint8_t *data, uint16_t length) = 0;
+
+    /**
+     * @brief Writes length bytes to address (it can be kept in RAM until commit)
+     */
+    virtual void write(uint16_t address, const uint8_t *data, uint16_t length) = 0;
+
+    /**
+     * @brief Makes the written data persistent (flash based backends)
+     */
+    virtual void commit() {};
+};
+
+#if defined(__AVR__) || defined(ESP8266) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_STM32)
+/**
+ * @ingroup GA05
+ * @brief EEPROM backend (AVR EEPROM; ESP8266, RP2040 and STM32 EEPROM emulated in flash)
+ * @details On AVR only the bytes that changed are written (EEPROM.update). On ESP8266 and RP2040 the EEPROM
+ * @details emulation keeps a RAM copy and commit writes the flash sector.
+ */
+class BK108XEepromBackend : public BK108XStorageBackend
+{
+private:
+    uint16_t start;
+    uint16_t length;
+
+public:
+    /**
+     * @param start   first EEPROM address used
+     * @param length  number of bytes used
+     */
+    BK108XEepromBackend(uint16_t start, uint16_t length) : start(start), length(length) {};
+
+    bool begin()
+    {
+#if defined(BK_STORAGE_EEPROM_COMMIT)
+        EEPROM.begin(this->start + this->length);
+#endif
+        return true;
+    };
+
+    uint16_t size() { return this->length; };
+
+    void read(uint16_t address, uint8_t *data, uint16_t length)
+    {
+        for (uint16_t i = 0; i < length; i++)
+            data[i] = EEPROM.read(this->start + address + i);
+    };
+
+    void write(uint16_t address, const uint8_t *data, uint16_t length)
+    {
+        for (uint16_t i = 0; i < length; i++)
+#if defined(__AVR__)
+            EEPROM.update(this->start + address + i, data[i]);
+#else
+            EEPROM.write(this->start + address + i, data[i]);
+#endif
+    };
+
+    void commit()
+    {
+#if defined(BK_STORAGE_EEPROM_COMMIT)
+        EEPROM.commit();
+#endif
+    };
+};
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+/**
+ * @ingroup GA05
+ * @brief ESP32 NVS backend (Preferences)
+ * @details The NVS does its own wear leveling. The storage area is a RAM image saved as a single blob on commit.
+ * @tparam SIZE size of the storage area in bytes
+ */
+template <uint16_t SIZE>
+class BK108XPreferencesBackend : public BK108XStorageBackend
+{
+private:
+    Preferences preferences;
+    const char *name;
+    const char *key;
+    uint8_t image[SIZE];
+
+public:
+    /**
+     * @param name  NVS namespace
+     * @param key   NVS key of the blob
+     */
+    BK108XPreferencesBackend(const char *name = "bk108x", const char *key = "storage") : name(name), key(key)
+    {
+        memset(this->image, 0xFF, SIZE);
+    };
+
+    bool begin()
+    {
+        if (!this->preferences.begin(this->name, false))
+            return false;
+        this->preferences.getBytes(this->key, this->image, SIZE);
+        return true;
+    };
+
+    uint16_t size() { return SIZE; };
+    void read(uint16_t address, uint8_t *data, uint16_t length) { memcpy(data, &this->image[address], length); };
+    void write(uint16_t address, const uint8_t *data, uint16_t length) { memcpy(&this->image[address], data, length); };
+    void commit() { this->preferences.putBytes(this->key, this->image, SIZE); };
+};
+#endif
+
+/**
+ * @ingroup GA05
+ * @brief Wear leveled, CRC checked record storage
+ * @details The storage area is divided in slots of (4 + record size) bytes: sequence number, CRC-16 and the record.
+ * @details Each commit writes the next slot with the next sequence number. The slot with the highest sequence
+ * @details number and a valid CRC is the current record. A power loss during a write keeps the previous record.
+ */
+class BK108XStorage
+{
+private:
+    BK108XStorageBackend *backend;
+    uint16_t recordSize;           //!< Size of the user record
+    uint8_t slots;                 //!< Number of record slots in the storage area
+    uint8_t currentSlot = 0;       //!< Slot of the last record written or loaded
+    uint16_t sequence = 0;         //!< Sequence number of the last record written or loaded
+    bool hasRecord = false;        //!< false if no valid record was found yet
+    bool ready = false;            //!< false until the backend is initialized by begin
+    const void *pending = NULL;    //!< Record waiting for the deferred commit
+    uint32_t changeTime = 0;       //!< millis() of the last update
+    uint16_t commitDelay = BK_STORAGE_COMMIT_DELAY;
+    uint16_t commits = 0;          //!< Number of records written
+
+    uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t length);
+    uint16_t recordCrc(uint16_t sequence, const uint8_t *record);
+    uint16_t slotAddress(uint8_t slot) { return slot * (this->recordSize + 4); };
+    bool checkSlot(uint8_t slot, uint16_t &sequence);
+    bool isSlotEqual(uint8_t slot, const uint8_t *record);
+
+public:
+    BK108XStorage(BK108XStorageBackend &backend, uint16_t recordSize);
+
+    bool begin(void *record);
+    void update(const void *record);
+    bool loop();
+    bool commit(const void *record);
+    bool flush();
+
+    /**
+     * @ingroup GA05
+     * @brief Sets the quiet time before a deferred commit
+     * @param ms_value  time in ms since the last update (default BK_STORAGE_COMMIT_DELAY)
+     */
+    inline void setCommitDelay(uint16_t ms_value) { this->commitDelay = ms_value; };
+
+    /**
+     * @ingroup GA05
+     * @brief Checks if there is a change waiting for the deferred commit
+     */
+    inline bool isPending() { return this->pending != NULL; };
+
+    /**
+     * @ingroup GA05
+     * @brief Number of record slots of the storage area (each slot is written once every getSlots() commits)
+     */
+    inline uint8_t getSlots() { return this->slots; };
+
+    /**
+     * @ingroup GA05
+     * @brief Number of records written since begin
+     */
+    inline uint16_t getCommits() { return this->commits; };
+};
+
+#endif // _BK108X_STORAGE_H
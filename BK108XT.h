@@ -0,0 +1,315 @@
+/**
+ * @brief PU2CLR BK108X Arduino Library - Compile-time configured driver
+ * @details BK108XT is the BK108X driver for boards with hard-wired SDIO/SCLK pins and oscillator.
+ * @details The pins, the bus (transport), the oscillator type and the optional features (RDS, AM) are template
+ * @details parameters. With BK108XPinBus (default bus) the pins and the I2C clock delay are constants, so the
+ * @details bit-bang loops are expanded without the runtime pin and fast I/O checks of the BK108X built-in bus.
+ * @details FEATURES only removes RAM with the BK108X_SLIM profile: without BK_FEATURE_RDS, a slim BK108XT has no
+ * @details RDS buffers. In the default build, FEATURES saves no RAM and no code: the RDS buffers are part of the 
+ * @details BK108X base class, and tick and update keep the RDS code linked. In both builds, FEATURES only 
+ * @details makes BK108XT::setAM and BK108XT::setRds fail to compile. Calls through a BK108X reference are not checked.
+ *
+ * @code
+ * #include <BK108XT.h>
+ *
+ * BK108XT<4, 5> rx;                      // SDIO = D4, SCLK = D5, crystal, RDS and AM
+ * // BK108XT<4, 5, BK108XPinBus<4, 5>, OSCILLATOR_TYPE_CRYSTAL, BK_FEATURE_RDS> rx; // FM only
+ *
+ * void setup() {
+ *   rx.setup();
+ *   rx.setFM(8400, 10800, 10390, 10);
+ * }
+ * @endcode
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#ifndef _BK108X_T_H // Prevent this file from being compiled more than once
+#define _BK108X_T_H
+
+#include <BK108X.h>
+#include <BK108XIO.h>
+
+#define BK_FEATURE_RDS 1 //!< BK108XT feature: RDS (setRds)
+#define BK_FEATURE_AM 2  //!< BK108XT feature: AM, SW and LW (setAM)
+#define BK_FEATURE_ALL (BK_FEATURE_RDS | BK_FEATURE_AM)
+
+/**
+ * @ingroup GA02
+ * @brief Bit-banged I2C bus with compile-time pins
+ * @details Same protocol as the BK108X built-in bus. On AVR, ESP32, RP2040 and STM32 the pins are toggled through
+ * @details the port registers (resolved once by begin); on other platforms digitalWrite/digitalRead are called with
+ * @details constant pins.
+ * @tparam SDIO         MCU pin connected to SDIO
+ * @tparam SCLK         MCU pin connected to SCLK
+ * @tparam HALF_PERIOD  I2C half clock period in microseconds (0 = as fast as the MCU can toggle the pins)
+ * @tparam ADDRESS      device address (see setI2C)
+ */
+template <uint8_t SDIO, uint8_t SCLK, uint8_t HALF_PERIOD = I2C_DEFAULT_HALF_PERIOD, uint8_t ADDRESS = I2C_DEVICE_ADDR>
+class BK108XPinBus : public BK108XTransport
+{
+private:
+#if defined(BK108X_FAST_IO)
+#if !defined(__AVR__) && !defined(ARDUINO_ARCH_STM32)
+    static_assert(SDIO < 32 && SCLK < 32, "BK108XPinBus: direct port I/O supports GPIO 0 to 31");
+#endif
+    bk_io_pin ioSdio, ioSclk; //!< SDIO and SCLK port/mask pairs resolved by begin
+
+    inline void sdioWrite(uint8_t value) { if (value) BK_IO_HIGH(ioSdio); else BK_IO_LOW(ioSdio); };
+    inline void sclkWrite(uint8_t value) { if (value) BK_IO_HIGH(ioSclk); else BK_IO_LOW(ioSclk); };
+    inline void sdioMode(uint8_t mode) { if (mode == OUTPUT) BK_IO_OUTPUT(ioSdio); else BK_IO_INPUT(ioSdio); };
+    inline void sclkOutput() { BK_IO_OUTPUT(ioSclk); };
+    inline uint8_t sdioRead() { return BK_IO_READ(ioSdio); };
+#else
+    inline void sdioWrite(uint8_t value) { digitalWrite(SDIO, value); };
+    inline void sclkWrite(uint8_t value) { digitalWrite(SCLK, value); };
+    inline void sdioMode(uint8_t mode) { pinMode(SDIO, mode); };
+    inline void sclkOutput() { pinMode(SCLK, OUTPUT); };
+    inline uint8_t sdioRead() { return digitalRead(SDIO); };
+#endif
+
+    inline void i2cDelay()
+    {
+        if (HALF_PERIOD)
+            delayMicroseconds(HALF_PERIOD);
+    };
+
+    inline void i2cBeginTransaction()
+    {
+        sdioMode(OUTPUT);
+        sclkOutput();
+        sdioWrite(HIGH);
+        sclkWrite(HIGH);
+        i2cDelay();
+
+        sdioWrite(LOW);
+        i2cDelay();
+        sclkWrite(LOW);
+        i2cDelay();
+        sdioWrite(HIGH);
+    };
+
+    inline void i2cEndTransaction()
+    {
+        sdioMode(OUTPUT);
+        sdioWrite(LOW);
+        i2cDelay();
+        sclkWrite(HIGH);
+        i2cDelay();
+        sdioWrite(HIGH);
+        i2cDelay();
+    };
+
+    inline void i2cSendAck(uint8_t value)
+    {
+        sdioMode(OUTPUT);
+        sclkWrite(LOW);
+        sdioWrite(value);
+        i2cDelay();
+        sclkWrite(HIGH);
+        i2cDelay();
+        sclkWrite(LOW);
+    };
+
+    inline uint8_t i2cReceiveAck()
+    {
+        uint8_t ack;
+        sdioMode(INPUT);
+        i2cDelay();
+        sclkWrite(HIGH);
+        i2cDelay();
+        ack = sdioRead();
+        sclkWrite(LOW);
+        i2cDelay();
+        return ack;
+    };
+
+    inline void i2cWriteByte(uint8_t data)
+    {
+        sdioMode(OUTPUT);
+        i2cDelay();
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            sdioWrite(data & 0x80);
+            i2cDelay();
+            sclkWrite(HIGH);
+            i2cDelay();
+            sclkWrite(LOW);
+            data = data << 1;
+        }
+    };
+
+    inline uint8_t i2cReadByte()
+    {
+        uint8_t value = 0;
+        sdioMode(INPUT);
+        i2cDelay();
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            sclkWrite(HIGH);
+            value = value << 1;
+            i2cDelay();
+            if (sdioRead())
+                value = value | 1;
+            sclkWrite(LOW);
+            i2cDelay();
+        }
+        return value;
+    };
+
+public:
+    /**
+     * @brief Resolves the pins to their port registers (direct port I/O)
+     * @return false if a pin cannot be toggled through the port registers (the setup functions fail)
+     */
+    bool begin()
+    {
+#if defined(BK108X_FAST_IO)
+        return bkResolvePin(SDIO, ioSdio, true) && bkResolvePin(SCLK, ioSclk, false);
+#else
+        return true;
+#endif
+    };
+
+    bool write(uint8_t reg, const uint8_t *data, uint8_t length)
+    {
+        bool ack;
+        i2cBeginTransaction();
+        i2cWriteByte(ADDRESS);
+        ack = i2cReceiveAck() == 0;
+        if (ack)
+        {
+            i2cWriteByte(reg << 1); // Converts address and sets to write operation
+            ack = i2cReceiveAck() == 0;
+        }
+        for (uint8_t i = 0; ack && i < length; i++)
+        {
+            i2cWriteByte(data[i]);
+            ack = i2cReceiveAck() == 0;
+        }
+        i2cEndTransaction();
+        return ack;
+    };
+
+    bool read(uint8_t reg, uint8_t *data, uint8_t length)
+    {
+        bool ack;
+        i2cBeginTransaction();
+        i2cWriteByte(ADDRESS);
+        ack = i2cReceiveAck() == 0;
+        if (ack)
+        {
+            i2cWriteByte((reg << 1) | 1); // Converts address and sets to read operation
+            ack = i2cReceiveAck() == 0;
+        }
+        for (uint8_t i = 0; ack && i < length; i++)
+        {
+            data[i] = i2cReadByte();
+            i2cSendAck(i == length - 1); // NACK after the last byte
+        }
+        i2cEndTransaction();
+        return ack;
+    };
+};
+
+#if defined(BK108X_SLIM)
+/**
+ * @ingroup GA01
+ * @brief RDS buffers of a BK108XT (BK108X_SLIM profile)
+ * @details Empty (no RAM, empty base class) if the features do not include BK_FEATURE_RDS.
+ */
+template <bool RDS>
+class BK108XTRdsBuffers
+{
+protected:
+    inline void attachRdsBuffers(BK108X &rx) { (void)rx; };
+};
+
+template <>
+class BK108XTRdsBuffers<true>
+{
+private:
+    bk_rds_data rdsBuffers;
+
+protected:
+    inline void attachRdsBuffers(BK108X &rx) { rx.setRdsBuffers(&this->rdsBuffers); };
+};
+#endif
+
+/**
+ * @ingroup GA03
+ * @brief BK108X driver configured at compile time
+ * @details All the BK108X functions are available. setup does not receive the pins and the oscillator type.
+ * @details Only the BK108X_SLIM profile (see bk_rds_data) drops the RDS buffers (276 bytes on AVR) when FEATURES does 
+ * @details not include BK_FEATURE_RDS. In the default build they stay in the BK108X base class, and a FM only or 
+ * @details AM only BK108XT has the same size and code as a BK108X. The other RDS state (PI and alternative 
+ * @details frequencies) and the RDS decoder stay in the base class in both builds.
+ * @tparam SDIO        MCU pin connected to SDIO
+ * @tparam SCLK        MCU pin connected to SCLK
+ * @tparam BUS         bus transport (default BK108XPinBus<SDIO, SCLK>)
+ * @tparam OSCILLATOR  OSCILLATOR_TYPE_CRYSTAL or OSCILLATOR_TYPE_REFCLK
+ * @tparam FEATURES    BK_FEATURE_RDS and/or BK_FEATURE_AM (default BK_FEATURE_ALL)
+ */
+template <uint8_t SDIO, uint8_t SCLK, class BUS = BK108XPinBus<SDIO, SCLK>, uint8_t OSCILLATOR = OSCILLATOR_TYPE_CRYSTAL, uint8_t FEATURES = BK_FEATURE_ALL>
+class BK108XT : public BK108X
+#if defined(BK108X_SLIM)
+    , private BK108XTRdsBuffers<(FEATURES & BK_FEATURE_RDS) != 0>
+#endif
+{
+private:
+    BUS bus;
+
+public:
+    /**
+     * @ingroup GA03
+     * @brief Starts the device (see BK108X::setup)
+     * @param rdsInterruptPin   optional. Ignored if BK_FEATURE_RDS is not set.
+     * @param seekInterruptPin  optional.
+     * @return false if the bus could not be set up (see BK108XPinBus::begin)
+     */
+    bool setup(int rdsInterruptPin = -1, int seekInterruptPin = -1)
+    {
+        setTransport(&this->bus);
+#if defined(BK108X_SLIM)
+        this->attachRdsBuffers(*this);
+#endif
+        return BK108X::setup(SDIO, SCLK, (FEATURES & BK_FEATURE_RDS) ? rdsInterruptPin : -1, seekInterruptPin, OSCILLATOR);
+    };
+
+    /**
+     * @ingroup GA03
+     * @brief Starts the device from a saved state (see BK108X::setup and restoreState)
+     */
+    bool setup(const bk_state &state, int rdsInterruptPin = -1, int seekInterruptPin = -1)
+    {
+        setTransport(&this->bus);
+#if defined(BK108X_SLIM)
+        this->attachRdsBuffers(*this);
+#endif
+        return BK108X::setup(SDIO, SCLK, state, (FEATURES & BK_FEATURE_RDS) ? rdsInterruptPin : -1, seekInterruptPin);
+    };
+
+    /**
+     * @ingroup GA03
+     * @brief Gets the bus transport
+     */
+    inline BUS &getBus() { return this->bus; };
+
+    void setAM(uint16_t minimum_frequency, uint16_t maximum_frequency, uint16_t default_frequency, uint16_t step, uint16_t am_space = 0)
+    {
+        static_assert((FEATURES & BK_FEATURE_AM) != 0, "BK108XT: AM is disabled (see BK_FEATURE_AM)");
+        BK108X::setAM(minimum_frequency, maximum_frequency, default_frequency, step, am_space);
+    };
+
+    void setRds(bool value)
+    {
+        static_assert((FEATURES & BK_FEATURE_RDS) != 0, "BK108XT: RDS is disabled (see BK_FEATURE_RDS)");
+        BK108X::setRds(value);
+    };
+
+    inline void setRDS(bool value) { setRds(value); };
+};
+
+#endif // _BK108X_T_H
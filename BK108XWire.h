@@ -0,0 +1,122 @@
+/**
+ * @brief PU2CLR BK108X Arduino Library - Hardware I2C (Wire) transport
+ * @details BK108XWireBus sends the BK108X register transactions through a TwoWire peripheral (400kHz by default).
+ * @details The bus work is done by the I2C peripheral (and its interrupt/FIFO or DMA driver, depending on the core)
+ * @details instead of toggling the pins in software.
+ *
+ * @warning The BK1086/88 read frame (START, 0x80, (reg << 1) | 1, data..., STOP) has no repeated START, which a
+ * @warning TwoWire master cannot generate. Reads are done with the standard combined format instead:
+ * @warning START, 0x80, (reg << 1) | 1, repeated START, 0x81, data..., STOP. Writes are identical to the datasheet.
+ * @warning begin() reads the device ID (REG00) in that format, so setup() returns false if the device does not
+ * @warning answer the combined read. In that case, use the BK108X built-in bus (or BK108XPinBus) instead.
+ *
+ * @code
+ * #include <BK108X.h>
+ * #include <BK108XWire.h>
+ *
+ * BK108X rx;
+ * BK108XWireBus bus(Wire, 400000);
+ *
+ * void setup() {
+ *   // Wire.setPins(SDA_PIN, SCL_PIN);  // ESP32: select the pins before setup if they are not the default ones
+ *   rx.setTransport(&bus);
+ *   if (!rx.setup(-1, -1))              // The pins are owned by Wire
+ *     Serial.println("BK108X does not answer the I2C combined read");
+ *   rx.setFM(8400, 10800, 10390, 10);
+ * }
+ * @endcode
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#ifndef _BK108X_WIRE_H // Prevent this file from being compiled more than once
+#define _BK108X_WIRE_H
+
+#include <BK108X.h>
+#include <Wire.h>
+
+#define I2C_WIRE_DEFAULT_CLOCK 400000 //!< Default TwoWire clock (Hz)
+
+#ifndef BK_WIRE_BUFFER
+#define BK_WIRE_BUFFER 32 //!< TwoWire buffer size (32 bytes on AVR). Longer bursts are split at register boundaries.
+#endif
+
+/**
+ * @ingroup GA02
+ * @brief TwoWire (hardware I2C) transport
+ */
+class BK108XWireBus : public BK108XTransport
+{
+private:
+    TwoWire *wire;
+    uint32_t clock;
+    uint8_t address; //!< 7 bits address (the BK108X 0x80 device byte is 0x40 << 1)
+
+public:
+    /**
+     * @param wire     TwoWire peripheral (Wire, Wire1...)
+     * @param clock    bus clock in Hz
+     * @param address  7 bits device address (I2C_DEVICE_ADDR >> 1)
+     */
+    BK108XWireBus(TwoWire &wire = Wire, uint32_t clock = I2C_WIRE_DEFAULT_CLOCK, uint8_t address = I2C_DEVICE_ADDR >> 1)
+        : wire(&wire), clock(clock), address(address) {};
+
+    /**
+     * @brief Starts the TwoWire peripheral and checks that the device answers a read
+     * @details Reads the device ID register. A NACK, or an ID of 0x0000 or 0xFFFF (floating or stuck bus), means the
+     * @details combined read format does not work with this device.
+     * @return false if the device ID could not be read
+     */
+    bool begin()
+    {
+        uint8_t id[2];
+        this->wire->begin();
+        this->wire->setClock(this->clock);
+        if (!this->read(REG00, id, 2))
+            return false;
+        uint16_t deviceId = (id[0] << 8) | id[1];
+        return deviceId != 0x0000 && deviceId != 0xFFFF;
+    };
+
+    bool write(uint8_t reg, const uint8_t *data, uint8_t length)
+    {
+        while (length > 0)
+        {
+            // The register address byte takes one position of the buffer; words are not split
+            uint8_t n = (length > ((BK_WIRE_BUFFER - 1) & ~1)) ? ((BK_WIRE_BUFFER - 1) & ~1) : length;
+            this->wire->beginTransmission(this->address);
+            this->wire->write((uint8_t)(reg << 1)); // Converts address and sets to write operation
+            this->wire->write(data, n);
+            if (this->wire->endTransmission() != 0)
+                return false;
+            reg += n / 2;
+            data += n;
+            length -= n;
+        }
+        return true;
+    };
+
+    bool read(uint8_t reg, uint8_t *data, uint8_t length)
+    {
+        while (length > 0)
+        {
+            uint8_t n = (length > (BK_WIRE_BUFFER & ~1)) ? (BK_WIRE_BUFFER & ~1) : length;
+            this->wire->beginTransmission(this->address);
+            this->wire->write((uint8_t)((reg << 1) | 1)); // Converts address and sets to read operation
+            if (this->wire->endTransmission(false) != 0)  // Repeated START
+                return false;
+            if (this->wire->requestFrom(this->address, n) != n)
+                return false;
+            for (uint8_t i = 0; i < n; i++)
+                data[i] = this->wire->read();
+            reg += n / 2;
+            data += n;
+            length -= n;
+        }
+        return true;
+    };
+};
+
+#endif // _BK108X_WIRE_H
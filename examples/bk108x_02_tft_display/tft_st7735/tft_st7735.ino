@@ -82,7 +82,7 @@
 #define TEST_BUTTON1         14  // Seek Station Up
 #define TEST_BUTTON2         15  // Seek Station Down
 
-#define POLLING_TIME  2000
+#define POLLING_TIME  250   // rx.update() costs a single I2C transaction and the display is redrawn only when something changes
 #define MIN_ELAPSED_TIME 150
 
 // The array sizes below can be optimized.
@@ -171,6 +171,7 @@ void setup()
   rx.setSoftMute(false); // Disable Soft Mute.
   
   rx.setFM(band[bandIdx].minimum_frequency, band[bandIdx].maximum_frequency, band[bandIdx].default_frequency, band[bandIdx].step);
+  rx.setTuneTargetMode(true); // The encoder only moves the target frequency. pollTune (see loop) tunes the latest one.
   showTemplate();
   showStatus();
 }
@@ -184,7 +185,7 @@ void rotaryEncoder()
 { // rotary encoder events
   uint8_t encoderStatus = encoder.process();
   if (encoderStatus)
-    encoderCount = (encoderStatus == DIR_CW) ? 1 : -1;
+    encoderCount += (encoderStatus == DIR_CW) ? 1 : -1;
 }
 
 
@@ -367,7 +368,10 @@ void showStatus()
   clearStatus();
   showFrequency();
   showVolume();
-
+  // The screen was cleared. So, draws the last values read by rx.update() even if they did not change.
+  showRSSI();
+  if (band[bandIdx].mode == MODE_FM)
+    showStereo();
 }
 
 /* *******************************
@@ -379,12 +383,10 @@ void showRSSI()
   int rssiLevel;
   int snrLevel;
   int maxAux = tft.width() - 10;
- 
-  if (band[bandIdx].mode ==  MODE_FM) 
-    showStereo();
 
-  rssiLevel = map(rx.getRssi(), 0, 127, 0, (maxAux - 48) );
-  snrLevel = map(rx.getSnr(), 0, 127, 0, (maxAux - 48));
+  // Values read by the last rx.update() - no new I2C transaction
+  rssiLevel = map(rx.getUpdatedRssi(), 0, 127, 0, (maxAux - 48) );
+  snrLevel = map(rx.getUpdatedSnr(), 0, 127, 0, (maxAux - 48));
 
   tft.fillRect(5, 42,  maxAux, 6, ST77XX_BLACK);
   tft.fillRect(5, 42, rssiLevel + 10, 6, ST77XX_ORANGE);
@@ -405,7 +407,7 @@ void showRSSI()
 
 void showStereo() {
   char stereo[10];
-  sprintf(stereo, "%s", (rx.isStereo()) ? "St" : "Mo");
+  sprintf(stereo, "%s", (rx.isUpdatedStereo()) ? "St" : "Mo");
   tft.setFont(NULL);
   tft.setTextSize(1);
   printValue(4, 4, oldStereo, stereo, 6, COLOR_WHITE);
@@ -551,16 +553,19 @@ void loop()
   // Check if the encoder has moved.
   if (encoderCount != 0)
   {
-    if (encoderCount == 1) {
+    noInterrupts();
+    int count = encoderCount;
+    encoderCount = 0;
+    interrupts();
+    // Each detent only moves the target frequency. So, a fast spin does not lag behind the knob.
+    for (; count > 0; count--)
       rx.setFrequencyUp();
-    }
-    else {
+    for (; count < 0; count++)
       rx.setFrequencyDown();
-    }
     showFrequency();
     bShow = true;
-    encoderCount = 0;
   }
+  rx.pollTune(); // Completes the tune (and re-tunes if the target moved meanwhile)
 
   // Check button commands
   if ((millis() - elapsedButton) > MIN_ELAPSED_TIME)
@@ -577,7 +582,12 @@ void loop()
   }
 
   if ( (millis() - pollin_elapsed) > POLLING_TIME ) {
-    showRSSI();
+    // Reads the status once and redraws only what changed
+    uint8_t changed = rx.update();
+    if (changed & (BK_CHANGED_RSSI | BK_CHANGED_SNR))
+      showRSSI();
+    if ((changed & BK_CHANGED_STEREO) && band[bandIdx].mode == MODE_FM)
+      showStereo();
     pollin_elapsed = millis();
   }
 
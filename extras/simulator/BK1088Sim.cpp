@@ -0,0 +1,726 @@
+/**
+ * @brief BK1088 register model, simulated bus and host Arduino HAL (see BK1088Sim.h)
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#include <Arduino.h>
+#include <BK108X.h>
+#include "BK1088Sim.h"
+
+#define SIM_MAX_STATIONS 64
+#define SIM_MS 1000000ULL        //!< ns in a ms
+#define SIM_RDS_PERIOD 87600000ULL  //!< One RDS group every 87.6ms (1187.5 bps)
+#define SIM_RDS_FIRST 20000000ULL   //!< First RDS group 20ms after the tune
+#define SIM_RDS_READY 40000000ULL   //!< RDSR stays high for 40ms
+#define SIM_IRQ_PULSE 5000000ULL    //!< GPIO2 low pulse (5ms)
+
+SimCounters simCounters;
+
+// Configuration
+static uint32_t ioCost = 3000;       // ns per pin operation (digitalWrite on a 16MHz AVR takes about 3 to 5us)
+static uint32_t tuneTime = 30;       // ms
+static uint32_t seekTime = 15;       // ms per channel
+static uint8_t noiseRssi = 10, noiseSnr = 2;
+static bool deadDevice = false;
+static uint32_t flakyEvery = 0, flakyCount = 0;
+static uint8_t pinSdio = 255, pinSclk = 255;
+static int pinGpio2 = -1;
+static void (*gpio2Isr)() = NULL;
+
+// Device
+static uint16_t regs[32];
+static SimStation stations[SIM_MAX_STATIONS];
+static uint8_t stationCount = 0;
+
+static const uint16_t fmStart[4] = {6400, 7400, 7600, 8700};
+static const uint16_t fmEnd[4] = {10800, 7600, 9100, 10800};
+static const uint16_t fmSpace[4] = {1, 5, 10, 20};
+static const uint16_t amStart[4] = {153, 520, 2300, 522};
+static const uint16_t amEnd[4] = {279, 1710, 21850, 1710};
+static const uint16_t amSpace[4] = {1, 5, 9, 10};
+
+// Pins and bus decoder
+static uint8_t sdioMode = INPUT, sclkMode = INPUT;
+static uint8_t sdioLatch = 1, sclkLatch = 1;
+static uint8_t lineSdio = 1, lineSclk = 1;
+static bool deviceDrive = false; // The device is pulling SDIO (ACK or data bit)
+static uint8_t deviceValue = 1;
+static bool inTransaction = false;
+static uint64_t transactionStart = 0;
+
+enum SimPhase { PHASE_IDLE, PHASE_ADDRESS, PHASE_REGISTER, PHASE_WRITE, PHASE_READ, PHASE_IGNORE };
+static SimPhase phase = PHASE_IDLE;
+static uint8_t bitCount = 0;
+static uint8_t shift = 0;
+static uint8_t pointer = 0;     // Register address counter
+static bool lowByteNext = false;
+static uint8_t highByte = 0;
+static bool readStarted = false;
+static bool masterAck = false; // Waiting for the master ACK/NACK of a byte read
+static uint8_t readValue = 0;
+static uint8_t readBit = 0;
+
+// Timeline
+static bool tuning = false;
+static uint64_t tuneDoneAt = 0;
+static bool seeking = false;
+static uint64_t seekStartAt = 0, seekDoneAt = 0;
+static int seekFrom = 0, seekTo = 0;
+static bool seekFail = false;
+static uint64_t nextRdsAt = 0, rdsReadyUntil = 0;
+static uint32_t rdsSequence = 0;
+static uint64_t gpio2LowUntil = 0;
+
+static uint8_t mode() { bk_reg07 r; r.raw = regs[REG07]; return r.refined.MODE; }
+static uint8_t band() { bk_reg05 r; r.raw = regs[REG05]; return r.refined.BAND; }
+static uint8_t space() { bk_reg05 r; r.raw = regs[REG05]; return r.refined.SPACE; }
+
+static uint16_t channelToFrequency(int channel)
+{
+    if (mode())
+        return amStart[band()] + channel * amSpace[space()];
+    return fmStart[band()] + channel * fmSpace[space()];
+}
+
+static int channels()
+{
+    if (mode())
+        return (amEnd[band()] - amStart[band()]) / amSpace[space()] + 1;
+    return (fmEnd[band()] - fmStart[band()]) / fmSpace[space()] + 1;
+}
+
+static const SimStation *stationAt(int channel)
+{
+    uint16_t frequency = channelToFrequency(channel);
+    for (uint8_t i = 0; i < stationCount; i++)
+        if (stations[i].mode == mode() && stations[i].frequency == frequency)
+            return &stations[i];
+    return NULL;
+}
+
+static uint16_t readChannel() { bk_reg0b r; r.raw = regs[REG0B]; return r.refined.READCHAN; }
+
+static void setReadChannel(int channel)
+{
+    bk_reg0b r;
+    r.raw = regs[REG0B];
+    r.refined.READCHAN = channel;
+    regs[REG0B] = r.raw;
+}
+
+static void updateSignal()
+{
+    const SimStation *s = stationAt(readChannel());
+    bk_reg09 r09;
+    bk_reg0a r0a;
+    r09.raw = regs[REG09];
+    r0a.raw = regs[REG0A];
+    r0a.refined.RSSI = s ? s->rssi : noiseRssi;
+    r0a.refined.ST = s ? s->stereo : 0;
+    r0a.refined.STEN = s ? s->stereo : 0;
+    r09.refined.SNR = s ? s->snr : noiseSnr;
+    regs[REG09] = r09.raw;
+    regs[REG0A] = r0a.raw;
+}
+
+static void pulseGpio2()
+{
+    bk_reg04 r;
+    r.raw = regs[REG04];
+    if (r.refined.GPIO2 != 1) // GPIO2 is not the interrupt output
+        return;
+    gpio2LowUntil = simCounters.now + SIM_IRQ_PULSE;
+    if (gpio2Isr != NULL)
+        gpio2Isr();
+}
+
+static void setStc(bool stc, bool fail)
+{
+    bk_reg0a r0a;
+    bk_reg04 r04;
+    r0a.raw = regs[REG0A];
+    r0a.refined.STC = stc;
+    r0a.refined.SF_BL = fail;
+    regs[REG0A] = r0a.raw;
+    r04.raw = regs[REG04];
+    if (stc && r04.refined.STCIEN)
+        pulseGpio2();
+}
+
+static void clearStatus()
+{
+    bk_reg0a r;
+    r.raw = regs[REG0A];
+    r.refined.STC = 0;
+    r.refined.SF_BL = 0;
+    r.refined.RDSR = 0;
+    regs[REG0A] = r.raw;
+}
+
+// Next group of the stream: 4 x 0A (PS), 16 x 2A (Radio Text) and 1 x 4A (Clock Time)
+static void rdsGroup(const SimStation *s, uint16_t block[4])
+{
+    uint32_t k = rdsSequence++ % 21;
+
+    block[0] = s->pi;
+    if (k < 4)
+    {
+        block[1] = (0 << 12) | (5 << 5) | k;
+        block[2] = (((8990 - 8750) / 10) << 8) | ((10130 - 8750) / 10); // AF 89.9MHz and 101.3MHz
+        block[3] = ((uint8_t)s->ps[k * 2] << 8) | (uint8_t)s->ps[k * 2 + 1];
+    }
+    else if (k < 20)
+    {
+        uint8_t segment = k - 4;
+        char text[64];
+        size_t length = (s->rt != NULL) ? strlen(s->rt) : 0;
+        if (length > 64)
+            length = 64;
+        memset(text, ' ', sizeof(text));
+        memcpy(text, s->rt, length);
+        if (length < 64)
+            text[length] = '\r';
+        block[1] = (2 << 12) | (5 << 5) | segment;
+        block[2] = ((uint8_t)text[segment * 4] << 8) | (uint8_t)text[segment * 4 + 1];
+        block[3] = ((uint8_t)text[segment * 4 + 2] << 8) | (uint8_t)text[segment * 4 + 3];
+    }
+    else
+    {
+        uint32_t mjd = 59000;
+        uint8_t hour = 12, minute = 34, offset = 2; // 12:34 +01:00
+        block[1] = (4 << 12) | (5 << 5) | ((mjd >> 15) & 3);
+        block[2] = ((mjd & 0x7FFF) << 1) | ((hour >> 4) & 1);
+        block[3] = ((hour & 0xF) << 12) | (minute << 6) | offset;
+    }
+}
+
+// Brings the device state up to simulated time
+static void advance()
+{
+    if (tuning && simCounters.now >= tuneDoneAt)
+    {
+        tuning = false;
+        updateSignal();
+        setStc(true, false);
+        nextRdsAt = simCounters.now + SIM_RDS_FIRST;
+    }
+
+    if (seeking)
+    {
+        if (simCounters.now >= seekDoneAt)
+        {
+            seeking = false;
+            setReadChannel(seekTo);
+            updateSignal();
+            setStc(true, seekFail);
+            nextRdsAt = simCounters.now + SIM_RDS_FIRST;
+        }
+        else
+        {
+            bk_reg02 r;
+            r.raw = regs[REG02];
+            int n = channels();
+            int steps = (int)((simCounters.now - seekStartAt) / (seekTime * SIM_MS));
+            setReadChannel(((seekFrom + (r.refined.SEEKUP ? steps : -steps)) % n + n) % n);
+            updateSignal();
+        }
+    }
+
+    bk_reg04 r04;
+    bk_reg0a r0a;
+    r04.raw = regs[REG04];
+    r0a.raw = regs[REG0A];
+    if (rdsReadyUntil && simCounters.now >= rdsReadyUntil)
+    {
+        r0a.refined.RDSR = 0;
+        regs[REG0A] = r0a.raw;
+        rdsReadyUntil = 0;
+    }
+
+    const SimStation *s = (!tuning && !seeking) ? stationAt(readChannel()) : NULL;
+    if (r04.refined.RDSEN && s != NULL && s->ps != NULL && nextRdsAt && simCounters.now >= nextRdsAt)
+    {
+        uint16_t block[4];
+        rdsGroup(s, block);
+        regs[REG0C] = block[0];
+        regs[REG0D] = block[1];
+        regs[REG0E] = block[2];
+        regs[REG0F] = block[3];
+        r0a.refined.RDSR = 1;
+        regs[REG0A] = r0a.raw;
+        rdsReadyUntil = simCounters.now + SIM_RDS_READY;
+        nextRdsAt += SIM_RDS_PERIOD;
+        if (nextRdsAt < simCounters.now)
+            nextRdsAt = simCounters.now + SIM_RDS_PERIOD;
+        simCounters.rdsGroups++;
+        if (r04.refined.RDSIEN)
+            pulseGpio2();
+    }
+}
+
+static void startSeek()
+{
+    bk_reg02 r02;
+    bk_reg05 r05;
+    bk_reg06 r06;
+    r02.raw = regs[REG02];
+    r05.raw = regs[REG05];
+    r06.raw = regs[REG06];
+
+    int n = channels();
+    int direction = r02.refined.SEEKUP ? 1 : -1;
+    int steps;
+
+    seeking = true;
+    seekStartAt = simCounters.now;
+    seekFrom = seekTo = readChannel();
+    seekFail = true;
+    for (steps = 1; steps <= n; steps++)
+    {
+        int channel = seekFrom + direction * steps;
+        if (channel < 0 || channel >= n)
+        {
+            if (r02.refined.SKMODE) // Stops at the band limit
+            {
+                seekTo = (channel < 0) ? 0 : n - 1;
+                break;
+            }
+            channel = (channel % n + n) % n;
+        }
+        const SimStation *s = stationAt(channel);
+        if (s != NULL && s->rssi >= r05.refined.SEEKTH && s->snr >= r06.refined.SKSNR)
+        {
+            seekTo = channel;
+            seekFail = false;
+            break;
+        }
+    }
+    seekDoneAt = simCounters.now + (uint64_t)steps * seekTime * SIM_MS + SIM_MS;
+    clearStatus();
+}
+
+static void registerWritten(uint8_t reg, uint16_t value)
+{
+    uint16_t old = regs[reg];
+
+    simCounters.registerWrites++;
+    if (reg <= REG01 || (reg >= REG09 && reg <= REG0F)) // Read only
+        return;
+    regs[reg] = value;
+
+    if (reg == REG03)
+    {
+        bk_reg03 before, after;
+        before.raw = old;
+        after.raw = value;
+        if (after.refined.TUNE && !before.refined.TUNE)
+        {
+            tuning = true;
+            tuneDoneAt = simCounters.now + tuneTime * SIM_MS;
+            setReadChannel(after.refined.CHAN);
+            clearStatus();
+            nextRdsAt = 0;
+        }
+        else if (!after.refined.TUNE)
+        {
+            bk_reg02 r02;
+            r02.raw = regs[REG02];
+            if (!seeking && !r02.refined.SEEK)
+                setStc(false, false);
+            tuning = false;
+            if (after.refined.CHAN != before.refined.CHAN)
+            {
+                setReadChannel(after.refined.CHAN);
+                updateSignal();
+            }
+        }
+    }
+    else if (reg == REG02)
+    {
+        bk_reg02 before, after;
+        before.raw = old;
+        after.raw = value;
+        if (after.refined.SEEK && !before.refined.SEEK)
+            startSeek();
+        else if (!after.refined.SEEK && before.refined.SEEK)
+        {
+            seeking = false;
+            setStc(false, false);
+            nextRdsAt = simCounters.now + SIM_RDS_FIRST;
+        }
+    }
+    else if (reg == REG05 || reg == REG07)
+        updateSignal();
+}
+
+static uint8_t nextReadByte()
+{
+    uint16_t value = regs[pointer & 0x1F];
+    if (!lowByteNext)
+    {
+        lowByteNext = true;
+        return value >> 8;
+    }
+    lowByteNext = false;
+    if ((pointer & 0x1F) == REG0A)
+        simCounters.statusReads++;
+    simCounters.registerReads++;
+    pointer = (pointer + 1) & 0x1F;
+    return value & 0xFF;
+}
+
+static bool nack()
+{
+    if (deadDevice)
+        return true;
+    return flakyEvery && (++flakyCount % flakyEvery) == 0;
+}
+
+static void byteReceived(uint8_t value)
+{
+    switch (phase)
+    {
+    case PHASE_ADDRESS:
+        phase = (value == I2C_DEVICE_ADDR) ? PHASE_REGISTER : PHASE_IGNORE;
+        break;
+    case PHASE_REGISTER:
+        pointer = value >> 1;
+        lowByteNext = false;
+        phase = (value & 1) ? PHASE_READ : PHASE_WRITE;
+        break;
+    case PHASE_WRITE:
+        if (!lowByteNext)
+        {
+            highByte = value;
+            lowByteNext = true;
+        }
+        else
+        {
+            lowByteNext = false;
+            registerWritten(pointer & 0x1F, (highByte << 8) | value);
+            pointer = (pointer + 1) & 0x1F;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void startReadByte()
+{
+    readValue = nextReadByte();
+    readBit = 0;
+    deviceDrive = true;
+    deviceValue = (readValue >> 7) & 1;
+}
+
+static void sclkRise()
+{
+    if (phase == PHASE_IDLE || phase == PHASE_IGNORE)
+        return;
+    if (phase == PHASE_READ)
+    {
+        if (masterAck && lineSdio) // NACK of the master ends the read
+            phase = PHASE_IGNORE;
+        return;
+    }
+    if (bitCount < 8)
+    {
+        shift = (shift << 1) | lineSdio;
+        bitCount++;
+    }
+}
+
+static void sclkFall()
+{
+    if (phase == PHASE_IDLE || phase == PHASE_IGNORE)
+    {
+        deviceDrive = false;
+        return;
+    }
+    if (phase == PHASE_READ)
+    {
+        if (!readStarted)
+            return;
+        if (masterAck)
+        {
+            masterAck = false;
+            startReadByte();
+            return;
+        }
+        if (++readBit < 8)
+            deviceValue = (readValue >> (7 - readBit)) & 1;
+        else
+        {
+            deviceDrive = false; // Releases SDIO for the master ACK
+            masterAck = true;
+        }
+        return;
+    }
+    if (bitCount == 8) // Device ACK (or NACK) clock
+    {
+        deviceDrive = !(phase == PHASE_ADDRESS && nack());
+        deviceValue = 0;
+        bitCount = 9;
+    }
+    else if (bitCount == 9)
+    {
+        SimPhase before = phase;
+        deviceDrive = false;
+        byteReceived(shift);
+        bitCount = 0;
+        shift = 0;
+        if (before == PHASE_REGISTER && phase == PHASE_READ)
+        {
+            readStarted = true;
+            masterAck = false;
+            startReadByte();
+        }
+    }
+}
+
+static uint8_t sdioLine()
+{
+    if (sdioMode == OUTPUT && !(deviceDrive && sdioLatch == 1))
+        return sdioLatch;
+    return deviceDrive ? deviceValue : 1; // Pull-up
+}
+
+static void busUpdate()
+{
+    uint8_t sclk = (sclkMode == OUTPUT) ? sclkLatch : 1;
+    uint8_t sdio = sdioLine();
+
+    if (sclk != lineSclk)
+    {
+        lineSclk = sclk;
+        lineSdio = sdio;
+        if (sclk)
+            sclkRise();
+        else
+            sclkFall();
+        lineSdio = (sdioMode == OUTPUT) ? sdioLatch : (deviceDrive ? deviceValue : 1);
+        return;
+    }
+    if (sdio != lineSdio)
+    {
+        if (lineSclk)
+        {
+            if (!sdio) // START
+            {
+                advance();
+                phase = PHASE_ADDRESS;
+                bitCount = 0;
+                shift = 0;
+                readStarted = false;
+                masterAck = false;
+                deviceDrive = false;
+                simCounters.transactions++;
+                inTransaction = true;
+                transactionStart = simCounters.now;
+            }
+            else // STOP
+            {
+                phase = PHASE_IDLE;
+                deviceDrive = false;
+                readStarted = false;
+                if (inTransaction)
+                    simCounters.busTime += simCounters.now - transactionStart;
+                inTransaction = false;
+            }
+        }
+        lineSdio = sdio;
+    }
+}
+
+static void elapse(uint64_t ns)
+{
+    simCounters.now += ns;
+    if (!inTransaction)
+        advance();
+}
+
+/**
+ * @brief Clears the device registers, the stations, the configuration and the counters
+ */
+void simReset()
+{
+    memset(regs, 0, sizeof(regs));
+    regs[REG00] = 0x0006; // Device ID
+    regs[REG01] = 0x1080; // Chip ID
+    memset(&simCounters, 0, sizeof(simCounters));
+    stationCount = 0;
+    ioCost = 3000;
+    tuneTime = 30;
+    seekTime = 15;
+    noiseRssi = 10;
+    noiseSnr = 2;
+    deadDevice = false;
+    flakyEvery = flakyCount = 0;
+    tuning = seeking = false;
+    nextRdsAt = rdsReadyUntil = gpio2LowUntil = 0;
+    rdsSequence = 0;
+    phase = PHASE_IDLE;
+    inTransaction = false;
+    deviceDrive = false;
+    gpio2Isr = NULL;
+}
+
+/**
+ * @brief Sets the MCU pins connected to the simulated device
+ * @param gpio2  pin connected to GPIO2 (interrupt output); -1 = not connected
+ */
+void simSetPins(uint8_t sdio, uint8_t sclk, int gpio2)
+{
+    pinSdio = sdio;
+    pinSclk = sclk;
+    pinGpio2 = gpio2;
+}
+
+/**
+ * @brief Adds a station to the simulated band (up to 64 stations)
+ */
+void simAddStation(const SimStation &station)
+{
+    if (stationCount < SIM_MAX_STATIONS)
+        stations[stationCount++] = station;
+}
+
+/**
+ * @brief Changes the RSSI and SNR of a station (fading, moving car...)
+ */
+void simSetStationSignal(uint16_t frequency, uint8_t rssi, uint8_t snr, uint8_t mode)
+{
+    for (uint8_t i = 0; i < stationCount; i++)
+        if (stations[i].mode == mode && stations[i].frequency == frequency)
+        {
+            stations[i].rssi = rssi;
+            stations[i].snr = snr;
+        }
+    if (!tuning && !seeking)
+        updateSignal();
+}
+
+/**
+ * @brief Sets the simulated time of each pinMode, digitalWrite and digitalRead call (default 3000ns)
+ */
+void simSetIoCost(uint32_t ns) { ioCost = ns; }
+
+/**
+ * @brief Sets the time from TUNE to STC (default 30ms)
+ */
+void simSetTuneTime(uint32_t ms) { tuneTime = ms; }
+
+/**
+ * @brief Sets the seek time per channel (default 15ms)
+ */
+void simSetSeekTime(uint32_t ms_per_channel) { seekTime = ms_per_channel; }
+
+/**
+ * @brief Sets the RSSI and SNR of the channels without station (default 10dBuV and 2dB)
+ */
+void simSetNoise(uint8_t rssi, uint8_t snr)
+{
+    noiseRssi = rssi;
+    noiseSnr = snr;
+}
+
+/**
+ * @brief Dead device: no transaction is acknowledged
+ */
+void simSetNack(bool value) { deadDevice = value; }
+
+/**
+ * @brief Flaky device: one of each every transactions is not acknowledged (0 = disabled)
+ */
+void simSetFlakyNack(uint32_t every)
+{
+    flakyEvery = every;
+    flakyCount = 0;
+}
+
+/**
+ * @brief Gets a register of the simulated device (not counted)
+ */
+uint16_t simGetRegister(uint8_t reg) { return regs[reg & 0x1F]; }
+
+/**
+ * @brief Sets a register of the simulated device without side effects
+ */
+void simSetRegister(uint8_t reg, uint16_t value) { regs[reg & 0x1F] = value; }
+
+// Host Arduino HAL
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    simCounters.now += ioCost;
+    if (pin == pinSdio)
+        sdioMode = (mode == OUTPUT) ? OUTPUT : INPUT;
+    else if (pin == pinSclk)
+        sclkMode = (mode == OUTPUT) ? OUTPUT : INPUT;
+    busUpdate();
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    simCounters.now += ioCost;
+    if (pin == pinSdio)
+        sdioLatch = value ? 1 : 0;
+    else if (pin == pinSclk)
+        sclkLatch = value ? 1 : 0;
+    busUpdate();
+}
+
+int digitalRead(uint8_t pin)
+{
+    simCounters.now += ioCost;
+    if (pin == pinSdio)
+        return sdioLine();
+    if ((int)pin == pinGpio2)
+        return (simCounters.now < gpio2LowUntil) ? LOW : HIGH;
+    return HIGH;
+}
+
+void delay(unsigned long ms)
+{
+    simCounters.delayCalls++;
+    simCounters.delayTime += ms * SIM_MS;
+    elapse(ms * SIM_MS);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    simCounters.delayTime += us * 1000ULL;
+    elapse(us * 1000ULL);
+}
+
+unsigned long millis()
+{
+    elapse(200);
+    return (unsigned long)(simCounters.now / SIM_MS);
+}
+
+unsigned long micros()
+{
+    elapse(200);
+    return (unsigned long)(simCounters.now / 1000ULL);
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int)
+{
+    if ((int)interrupt == pinGpio2)
+        gpio2Isr = isr;
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+    if ((int)interrupt == pinGpio2)
+        gpio2Isr = NULL;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+void yield() { elapse(1000); }
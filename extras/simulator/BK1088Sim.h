@@ -0,0 +1,72 @@
+/**
+ * @brief BK1088 register model and simulated bus for host builds of the BK108X library
+ * @details The simulator decodes the bit-banged I2C frames (START, 0x80, register address, data, STOP) from the
+ * @details pinMode/digitalWrite/digitalRead calls of the library, and answers with ACK and register data like a
+ * @details BK1088. Time is simulated: each pin operation costs a configurable time (see simSetIoCost) and delay/
+ * @details delayMicroseconds only advance the clock. So, the results do not depend on the host speed.
+ * @details The model emulates:
+ * @details - TUNE: STC after the tune time (see simSetTuneTime);
+ * @details - SEEK: READCHAN walks the band (see simSetSeekTime), STC and SF_BL at the first channel above the seek
+ * @details   thresholds (SEEKTH and SKSNR) or at the band limit/after a full turn;
+ * @details - RSSI, SNR and stereo per channel (see simAddStation and simSetNoise);
+ * @details - RDS: a stream of 0A (PS and the AFs 89.9 and 101.3MHz), 2A (Radio Text) and 4A (Clock Time) groups, one every 87.6ms, for the
+ * @details   stations with a PS name, signaled by RDSR and by GPIO2 pulses if the interrupts are enabled;
+ * @details - NACKs (dead or flaky device, see simSetNack and simSetFlakyNack).
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#ifndef _BK1088_SIM_H // Prevent this file from being compiled more than once
+#define _BK1088_SIM_H
+
+#include <stdint.h>
+
+/**
+ * @brief Station of the simulated band
+ */
+typedef struct
+{
+    uint16_t frequency; //!< 10kHz (FM) or 1kHz (AM) units, like setFrequency
+    uint8_t mode;       //!< 0 = FM; 1 = AM
+    uint8_t rssi;       //!< RSSI (dBuV)
+    uint8_t snr;        //!< SNR (dB)
+    bool stereo;        //!< Stereo indicator (ST/STEN)
+    uint16_t pi;        //!< RDS Program Identification
+    const char *ps;     //!< RDS Program Service name (8 characters). NULL = no RDS.
+    const char *rt;     //!< RDS Radio Text (up to 64 characters)
+} SimStation;
+
+/**
+ * @brief Simulator counters (see simReset)
+ */
+typedef struct
+{
+    uint64_t now;          //!< Simulated time (ns)
+    uint64_t busTime;      //!< Simulated time between START and STOP of the transactions (ns)
+    uint64_t delayTime;    //!< Simulated time in delay and delayMicroseconds (ns)
+    uint32_t transactions; //!< Bus transactions (START conditions)
+    uint32_t registerReads;  //!< Registers read by the library
+    uint32_t registerWrites; //!< Registers written by the library
+    uint32_t statusReads;  //!< Reads of the status register (0x0A)
+    uint32_t delayCalls;   //!< Calls of delay (ms)
+    uint32_t rdsGroups;    //!< RDS groups made available by the simulated device
+} SimCounters;
+
+extern SimCounters simCounters;
+
+void simReset();
+void simSetPins(uint8_t sdio, uint8_t sclk, int gpio2 = -1);
+void simAddStation(const SimStation &station);
+void simSetStationSignal(uint16_t frequency, uint8_t rssi, uint8_t snr, uint8_t mode = 0);
+void simSetIoCost(uint32_t ns);
+void simSetTuneTime(uint32_t ms);
+void simSetSeekTime(uint32_t ms_per_channel);
+void simSetNoise(uint8_t rssi, uint8_t snr);
+void simSetNack(bool value);
+void simSetFlakyNack(uint32_t every);
+uint16_t simGetRegister(uint8_t reg);
+void simSetRegister(uint8_t reg, uint16_t value);
+
+#endif // _BK1088_SIM_H
@@ -0,0 +1,173 @@
+/**
+ * @brief BK108X benchmark suite (host build with the BK1088 simulator)
+ * @details Runs the main operations of the library against the simulated device and reports, for each one, the
+ * @details bus transactions, the simulated bus time, the simulated total time (bus + delays) and the host wall
+ * @details time. Each result is also checked (frequency, station found, RDS text...), so the suite can be used as
+ * @details a regression test: the exit code is the number of failed checks.
+ * @details See README.md.
+ *
+ * Usage: bench [io_cost_ns]  (default 3000ns per pin operation)
+ *
+ * This library can be freely distributed using the MIT Free Software model.
+ * Copyright (c) 2020 Ricardo Lima Caratti.
+ * Contact: pu2clr@gmail.com
+ */
+
+#include <Arduino.h>
+#include <BK108X.h>
+#include <chrono>
+#include "BK1088Sim.h"
+
+#define SDIO_PIN 18
+#define SCLK_PIN 19
+
+static BK108X rx;
+static int failures = 0;
+
+typedef struct
+{
+    SimCounters sim;
+    std::chrono::steady_clock::time_point wall;
+} Mark;
+
+static Mark mark()
+{
+    Mark m;
+    m.sim = simCounters;
+    m.wall = std::chrono::steady_clock::now();
+    return m;
+}
+
+static void report(const char *name, const Mark &start, uint32_t repeat, bool ok, const char *result)
+{
+    double wall = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start.wall).count();
+    printf("%-22s %6.1f %10.3f %10.3f %10.1f %8.1f  %-4s %s\n", name,
+           (simCounters.transactions - start.sim.transactions) / (double)repeat,
+           (simCounters.busTime - start.sim.busTime) / 1e6 / repeat,
+           (simCounters.now - start.sim.now) / 1e6 / repeat,
+           wall / repeat,
+           (simCounters.statusReads - start.sim.statusReads) / (double)repeat,
+           ok ? "ok" : "FAIL", result);
+    if (!ok)
+        failures++;
+}
+
+int main(int argc, char **argv)
+{
+    char result[80];
+    Mark m;
+
+    simReset();
+    simSetPins(SDIO_PIN, SCLK_PIN);
+    if (argc > 1)
+        simSetIoCost(atoi(argv[1]));
+    simAddStation({8750, 0, 30, 20, false, 0, NULL, NULL});
+    simAddStation({9990, 0, 40, 25, true, 0x2222, "NEWS    ", "News every hour"});
+    simAddStation({8990, 0, 30, 20, true, 0x1234, "RADIO 1 ", "Hello world from the BK1088 simulator"}); // AF of RADIO 1
+    simAddStation({10130, 0, 35, 22, true, 0x5678, "OTHER   ", NULL}); // In the AF list of RADIO 1, but another PI
+    simAddStation({10390, 0, 45, 30, true, 0x1234, "RADIO 1 ", "Hello world from the BK1088 simulator"});
+    simAddStation({9500, 0, 12, 3, false, 0, NULL, NULL}); // Below the seek and scan thresholds
+
+    printf("%-22s %6s %10s %10s %10s %8s\n", "operation", "trans", "bus ms", "sim ms", "wall us", "status");
+
+    m = mark();
+    rx.setup(SDIO_PIN, SCLK_PIN);
+    snprintf(result, sizeof(result), "device id %04X", rx.getDeviceId());
+    report("powerUp (setup)", m, 1, rx.getDeviceId() == simGetRegister(REG00), result);
+
+    m = mark();
+    rx.setFM(8400, 10800, 10390, 10);
+    snprintf(result, sizeof(result), "%u", rx.getRealFrequency());
+    report("setFM", m, 1, rx.getRealFrequency() == 10390, result);
+
+    m = mark();
+    for (uint16_t f = 8800; f < 9000; f += 10)
+        rx.setFrequency(f);
+    snprintf(result, sizeof(result), "%u", rx.getRealFrequency());
+    report("setFrequency", m, 20, rx.getRealFrequency() == 8990, result);
+
+    m = mark();
+    for (uint8_t i = 0; i < 20; i++)
+        rx.setFrequencyUp();
+    snprintf(result, sizeof(result), "%u", rx.getRealFrequency());
+    report("setFrequencyUp", m, 20, rx.getRealFrequency() == 9190, result);
+
+    m = mark();
+    rx.setVolume(20);
+    report("setVolume", m, 1, rx.getVolume() == 20, "");
+
+    rx.setFrequency(10390);
+    m = mark();
+    rx.seekHardware(BK_SEEK_WRAP, BK_SEEK_DOWN);
+    snprintf(result, sizeof(result), "%u", rx.getFrequency());
+    report("seekHardware down", m, 1, rx.getFrequency() == 10130, result);
+
+    m = mark();
+    rx.seekHardware(BK_SEEK_WRAP, BK_SEEK_UP);
+    snprintf(result, sizeof(result), "%u", rx.getFrequency());
+    report("seekHardware up", m, 1, rx.getFrequency() == 10390, result);
+
+    m = mark();
+    uint8_t n = rx.scanBand();
+    snprintf(result, sizeof(result), "%u stations", n);
+    report("scanBand", m, 1, n == 5, result);
+
+    rx.setFrequency(10130);
+    bk_reg03 r03;
+    r03.raw = simGetRegister(REG03);
+    uint16_t otherChannel = r03.refined.CHAN; // Channel of the AF with another PI
+
+    rx.setFrequency(10390);
+#if defined(BK108X_SLIM)
+    static bk_rds_data rdsBuffers;
+    rx.setRdsBuffers(&rdsBuffers);
+#endif
+    rx.setRds(true);
+    m = mark();
+    uint32_t groups = simCounters.rdsGroups;
+    uint32_t start = millis();
+    while (millis() - start < 5000)
+    {
+        rx.getRdsReady();
+        delay(5);
+    }
+    snprintf(result, sizeof(result), "%u groups PS [%s]", simCounters.rdsGroups - groups, rx.getRdsText0A() ? rx.getRdsText0A() : "");
+    report("RDS decoding (5s)", m, 1, rx.getRdsText0A() != NULL && strncmp(rx.getRdsText0A(), "RADIO 1 ", 8) == 0, result);
+
+    // Alternative frequencies: 103.9MHz fades. The AFs (89.9 and 101.3MHz, sent in the 0A groups) are probed,
+    // 101.3MHz (stronger, but another PI) is rejected and 89.9MHz (same PI) is used.
+    rx.setAf(true);
+    simSetStationSignal(10390, 15, 5);
+    bool otherTuned = false, muted = false;
+    uint64_t muteStart = 0, muteMax = 0;
+    m = mark();
+    start = millis();
+    while (millis() - start < 15000 && rx.getFrequency() == 10390)
+    {
+        rx.tick(millis());
+        bk_reg02 r02;
+        r02.raw = simGetRegister(REG02);
+        r03.raw = simGetRegister(REG03);
+        if (r03.refined.CHAN == otherChannel)
+            otherTuned = true;
+        if ((r02.refined.MUTEL || r02.refined.MUTER) != muted)
+        {
+            muted = !muted;
+            if (muted)
+                muteStart = simCounters.now;
+            else if (simCounters.now - muteStart > muteMax)
+                muteMax = simCounters.now - muteStart;
+        }
+        delay(1);
+    }
+    snprintf(result, sizeof(result), "%u PI %04X", rx.getFrequency(), rx.getRdsPi());
+    report("AF switch (same PI)", m, 1, rx.getFrequency() == 8990 && rx.getRdsPi() == 0x1234, result);
+    m = mark();
+    snprintf(result, sizeof(result), "101.3MHz %s", otherTuned ? "checked and rejected" : "not checked");
+    report("AF reject (other PI)", m, 1, otherTuned && rx.getFrequency() != 10130, result);
+    snprintf(result, sizeof(result), "longest mute %.1fms", muteMax / 1e6);
+    report("AF mute window", m, 1, muteMax > 0 && muteMax <= 2 * BK_AF_PROBE_TIMEOUT * 1000000ULL, result);
+
+    printf("%d failed check(s)\n", failures);
+    return failures;
+}